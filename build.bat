@@ -1,7 +1,7 @@
 @echo off
 
 rem Complie
-gcc -I src/include -L src/lib -o src/bin/main src/main.c src/render.c src/astar.c -lmingw32 -lSDL2main -lSDL2
+gcc -I src/include -L src/lib -o src/bin/main src/main.c src/render.c src/astar.c src/grid.c src/generate.c src/bench.c src/config.c src/arena.c src/snapshot.c src/rng.c src/parallel.c src/camera.c src/lod.c src/ring.c src/simulation.c src/image.c src/headless.c src/recording.c src/hud.c -lmingw32 -lSDL2main -lSDL2
 
 
 rem Complie
@@ -0,0 +1,129 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+#define ALIGN_UP(n) (((n) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define BLOCK_HEADER ALIGN_UP(sizeof(ArenaBlock))
+
+// Each thread that runs searches gets its own arena
+static _Thread_local Arena threadArena;
+
+
+static unsigned char* blockData(ArenaBlock *block) {
+    return (unsigned char *)block + BLOCK_HEADER;
+}
+
+static ArenaBlock* newBlock(size_t capacity, ArenaBlock *prev) {
+    ArenaBlock *block = (ArenaBlock *)malloc(BLOCK_HEADER + capacity);
+    if (block == NULL) {
+        printf("Failed to allocate memory\n");
+        exit(EXIT_FAILURE);
+    }
+    block->prev = prev;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+int initArena(Arena *arena, size_t capacity) {
+    memset(arena, 0, sizeof(*arena));
+    arena->block = newBlock(ALIGN_UP(capacity), NULL);
+    return 0;
+}
+
+static void freeBlocks(ArenaBlock *block) {
+    while (block != NULL) {
+        ArenaBlock *prev = block->prev;
+        free(block);
+        block = prev;
+    }
+}
+
+void freeArena(Arena *arena) {
+    freeBlocks(arena->block);
+    arena->block = NULL;
+    arena->last = NULL;
+    arena->used = 0;
+}
+
+void* arenaAlloc(Arena *arena, size_t size) {
+    size = ALIGN_UP(size);
+    ArenaBlock *block = arena->block;
+    if (block == NULL || block->used + size > block->capacity) {
+        size_t capacity = block != NULL ? block->capacity * 2 : DEFAULT_ARENA_SIZE;
+        if (capacity < size) {
+            capacity = size;
+        }
+        if (block != NULL) {
+            arena->blockMallocs++;
+        }
+        block = newBlock(capacity, block);
+        arena->block = block;
+    }
+
+    void *memory = blockData(block) + block->used;
+    block->used += size;
+    arena->used += size;
+    if (arena->used > arena->highWater) {
+        arena->highWater = arena->used;
+    }
+    arena->last = memory;
+    return memory;
+}
+
+// Like realloc(); the newest allocation is extended in place when it fits
+void* arenaGrow(Arena *arena, void *memory, size_t oldSize, size_t newSize) {
+    oldSize = ALIGN_UP(oldSize);
+    newSize = ALIGN_UP(newSize);
+    ArenaBlock *block = arena->block;
+    if (memory != NULL && memory == arena->last && block->used - oldSize + newSize <= block->capacity) {
+        block->used += newSize - oldSize;
+        arena->used += newSize - oldSize;
+        if (arena->used > arena->highWater) {
+            arena->highWater = arena->used;
+        }
+        return memory;
+    }
+
+    void *grown = arenaAlloc(arena, newSize);
+    if (memory != NULL) {
+        memcpy(grown, memory, oldSize);
+    }
+    return grown;
+}
+
+// O(1) unless the last query spilled into extra blocks, in which case they
+// are replaced by one block sized for the high-water mark
+void resetArena(Arena *arena) {
+    if (arena->block != NULL && arena->block->prev != NULL) {
+        freeBlocks(arena->block);
+        arena->block = newBlock(ALIGN_UP(arena->highWater), NULL);
+    }
+    if (arena->block != NULL) {
+        arena->block->used = 0;
+    }
+    arena->last = NULL;
+    arena->used = 0;
+}
+
+size_t arenaCapacity(const Arena *arena) {
+    size_t capacity = 0;
+    for (ArenaBlock *block = arena->block; block != NULL; block = block->prev) {
+        capacity += block->capacity;
+    }
+    return capacity;
+}
+
+Arena* searchArena(void) {
+    if (threadArena.block == NULL) {
+        initArena(&threadArena, DEFAULT_ARENA_SIZE);
+    }
+    return &threadArena;
+}
+
+// Sizes the calling thread's arena up front so queries never have to grow it
+int reserveSearchArena(size_t capacity) {
+    freeArena(&threadArena);
+    return initArena(&threadArena, capacity);
+}
@@ -1,179 +1,276 @@
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include "arena.h"
 #include "astar.h"
-#include "render.h"
-#include "cursor.h"
-
-void initCellList(CellList *list, size_t initial_capacity) {
-    list->cells = (Cell **)malloc(initial_capacity * sizeof(Cell *));
-    if (list->cells == NULL) {
-        printf("Failed to allocate memory\n");
-        exit(EXIT_FAILURE); // Exit if memory allocation fails
-    }
+#include "grid.h"
+
+// The heap lives in the calling thread's search arena and is released in
+// bulk by resetArena() at the end of the query
+void initOpenList(OpenList *list, size_t initial_capacity) {
+    list->entries = (OpenEntry *)arenaAlloc(searchArena(), initial_capacity * sizeof(OpenEntry));
     list->size = 0;
     list->capacity = initial_capacity;
 }
 
+static inline int openBefore(const OpenEntry *a, const OpenEntry *b) {
+    return a->fCost < b->fCost || (a->fCost == b->fCost && a->hCost < b->hCost);
+}
 
-void push(CellList *list, Cell *cell) {
+void pushOpen(OpenList *list, uint32_t cell, int fCost, int hCost) {
     if (list->size >= list->capacity) {
-        // Resize the list
+        list->entries = arenaGrow(searchArena(), list->entries, list->capacity * sizeof(OpenEntry), list->capacity * 2 * sizeof(OpenEntry));
         list->capacity *= 2;
-        list->cells = realloc(list->cells, list->capacity * sizeof(Cell*));
-        
     }
-    list->cells[list->size++] = cell; 
+    OpenEntry entry = {fCost, hCost, cell};
+    size_t index = list->size++;
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!openBefore(&entry, &list->entries[parent])) {
+            break;
+        }
+        list->entries[index] = list->entries[parent];
+        index = parent;
+    }
+    list->entries[index] = entry;
 }
 
-
-
-Cell* pop(CellList *list) {
+// Takes the cheapest entry's cell, returning 0 when the heap is empty. The
+// cell may have closed since it was pushed.
+int popOpen(OpenList *list, uint32_t *cell) {
     if (list->size == 0) {
-        printf("Pop failure, list is empty\n");
-        return NULL;
+        return 0;
     }
-    return list->cells[--list->size];
-}
-
-Cell* removeCell(CellList *list, Cell *cell) {
-    size_t index = (size_t)-1; // Use a valid size_t value for initialization
-
-    for (size_t i = 0; i < list->size; i++) {
-        if (list->cells[i] == cell) {
-            index = i;
+    *cell = list->entries[0].cell;
+    OpenEntry last = list->entries[--list->size];
+    size_t index = 0;
+    for (;;) {
+        size_t child = 2 * index + 1;
+        if (child >= list->size) {
             break;
         }
+        if (child + 1 < list->size && openBefore(&list->entries[child + 1], &list->entries[child])) {
+            child++;
+        }
+        if (!openBefore(&list->entries[child], &last)) {
+            break;
+        }
+        list->entries[index] = list->entries[child];
+        index = child;
     }
-
-    if (index == (size_t)-1) {
-        printf("Remove Error, Cell not found\n");
-        return NULL;
-    }
-
-    // Shift elements to the left to fill the gap
-    for (size_t i = index; i < list->size - 1; i++) {
-        list->cells[i] = list->cells[i + 1];
-    }
-
-    list->size--;
-    return cell;
-}
-
-void freeCellList(CellList *list) {
-    if (list->cells != NULL) {
-        free(list->cells);
-        list->cells = NULL; // Ensure dangling pointer is cleared
-    }
+    list->entries[index] = last;
+    return 1;
 }
 
-
-
-int contains(CellList *list, Cell *cell) {
-    for (int i = 0; i < list->size; i++) {
-        if (list->cells[i] == cell) {
-            return 1;
-        }
-    }
-    return 0;
+void freeOpenList(OpenList *list) {
+    // The memory itself goes back when the arena is reset
+    list->entries = NULL;
+    list->size = 0;
+    list->capacity = 0;
 }
 
-int heuristic(Cell* a, Cell* b) {
-    int dx = abs(b->x - a->x);
-    int dy = abs(b->y - a->y);
+int heuristic(int row, int col, int toRow, int toCol) {
+    int dx = abs(toCol - col);
+    int dy = abs(toRow - row);
     return 10 * (dx + dy) + (14 - 2 * 10) * fmin(dx, dy);
 }
 
-void calculateCosts(Cell* current, Cell* start, Cell* end) {
-    current->gCost = heuristic(start, current); 
-    current->hCost = heuristic(current, end);
-    current->fCost = current->gCost + current->hCost;
-}
 
+typedef struct {
+    int row;
+    int col;
+} Neighbour;
 
-void updateNeighbours(Cell** grid, CellList* neighboursList, Cell* cell, const int* width, const int* height) {
+// Fills a fixed buffer with the walkable neighbours of (row, col) and
+// returns how many there are. Inlined into the expansion loop, so there is
+// no list to grow.
+static inline int updateNeighbours(const Grid* grid, int row, int col, Neighbour neighbours[MAX_NEIGHBOURS]) {
+    int count = 0;
     for (int i = -1; i <= 1; i++) {
+        int newY = row + i;
+        if (newY < 0 || newY >= grid->rows) {
+            continue;
+        }
         for (int j = -1; j <= 1; j++) {
-            if (i == 0 && j == 0) {
+            int newX = col + j;
+            if ((i == 0 && j == 0) || newX < 0 || newX >= grid->cols) {
                 continue; // Skip the current cell
             }
-            int newX = cell->x + j;
-            int newY = cell->y + i;
-            if (newX >= 0 && newY >= 0 && newX < *width && newY < *height) {
-                push(neighboursList, &grid[newY][newX]);
+            if (isWalkable(grid, newY, newX)) {
+                neighbours[count].row = newY;
+                neighbours[count].col = newX;
+                count++;
             }
         }
     }
+    return count;
+}
+
+
+// With tracing off this is one well-predicted branch. A full ring drops
+// the event rather than holding up the search.
+static inline void traceCell(Search *search, int row, int col, TraceEventType type) {
+    if (search->trace != NULL) {
+        TraceEvent event = {(uint32_t)row * (uint32_t)search->grid->cols + (uint32_t)col, (uint32_t)type};
+        if (pushRing(search->trace, &event) != 0) {
+            search->traceDropped++;
+        }
+    }
+}
+
+void initSearch(Search *search) {
+    search->grid = NULL;
+    search->startCell = NULL;
+    search->endCell = NULL;
+    search->endRow = 0;
+    search->endCol = 0;
+    search->status = SEARCH_IDLE;
+    search->trace = NULL;
+    search->traceDropped = 0;
+    memset(&search->stats, 0, sizeof(search->stats));
+}
+
+static void noteArena(Search *search) {
+    Arena *arena = searchArena();
+    if (arena->used > search->stats.arenaPeak) {
+        search->stats.arenaPeak = arena->used;
+    }
+    search->stats.arenaReserved = arenaCapacity(arena);
 }
 
+static void endSearch(Search *search, SearchStatus status) {
+    noteArena(search);
+    search->stats.status = status;
+    freeOpenList(&search->open);
+    resetArena(searchArena());
+    search->status = status;
+}
 
-void astar(Cursor* cursor, SDL_Renderer *renderer, const Color* colors, Cell **grid, Cell *startCell, Cell *endCell, const int* width, const int* height, const int* rows, const int* cols, const int* spacing) {
-    CellList open;
-    CellList close;
-    CellList neighbours;
-    CellList path;
-    initCellList(&open, 2);
-    initCellList(&close, 2);
-    initCellList(&neighbours, 8);
-    initCellList(&path, 1);
+void startSearch(Search *search, Grid *grid, Cell *startCell, Cell *endCell) {
+    stopSearch(search);
+    search->grid = grid;
+    search->startCell = startCell;
+    search->endCell = endCell;
+    search->status = SEARCH_RUNNING;
+    memset(&search->stats, 0, sizeof(search->stats));
+    search->stats.status = SEARCH_RUNNING;
+    initOpenList(&search->open, 64);
 
-    calculateCosts(startCell, startCell, endCell);
-    push(&open, startCell);
+    int startRow, startCol;
+    cellPosition(grid, indexOfCell(grid, startCell), &startRow, &startCol);
+    cellPosition(grid, indexOfCell(grid, endCell), &search->endRow, &search->endCol);
 
+    beginSearch(grid);
+    touchCell(grid, startCell);
+    startCell->gCost = 0;
+    startCell->hCost = heuristic(startRow, startCol, search->endRow, search->endCol);
+    pushOpen(&search->open, (uint32_t)indexOfCell(grid, startCell), startCell->hCost, startCell->hCost);
+    startCell->isOpen = 1;
+    markDirty(grid, startRow, startCol);
+    traceCell(search, startRow, startCol, TRACE_OPEN);
+}
 
-    while (open.size != 0) {
-        Cell* currentCell = open.cells[0];
-        for (size_t i = 0; i < open.size; i++) {
-            if (open.cells[i]->fCost < currentCell->fCost || open.cells[i]->fCost == currentCell->fCost && open.cells[i]->hCost < currentCell->hCost) {
-                currentCell = open.cells[i];
-            }
+// Expands up to `expansions` cells of a running search
+SearchStatus stepSearch(Search *search, size_t expansions) {
+    Grid *grid = search->grid;
+    OpenList *open = &search->open;
+    Cell *endCell = search->endCell;
+    Neighbour neighbours[MAX_NEIGHBOURS];
+    Uint64 started = SDL_GetPerformanceCounter();
+
+    for (size_t step = 0; step < expansions && search->status == SEARCH_RUNNING; step++) {
+        uint32_t current;
+        int found = popOpen(open, &current);
+        while (found && grid->cells[current].isClosed) {
+            found = popOpen(open, &current);
+        }
+        if (!found) {
+            printf("No Solution Found\n");
+            endSearch(search, SEARCH_FAILED);
+            break;
         }
-        removeCell(&open, currentCell);
-        push(&close, currentCell);
+        Cell *currentCell = &grid->cells[current];
+        int row, col;
+        cellPosition(grid, current, &row, &col);
+        search->stats.expanded++;
+        currentCell->isOpen = 0;
         currentCell->isClosed = 1;
+        markDirty(grid, row, col);
+        countHeat(grid, row, col);
+        traceCell(search, row, col, TRACE_CLOSE);
         if (currentCell == endCell) {
-            Cell* currentBackCell = endCell;
-            while (currentBackCell != NULL) {
-                push(&path, currentBackCell);
-                currentBackCell->isPath = 1;
-                currentBackCell = currentBackCell->parent;
+            search->stats.pathCost = endCell->gCost;
+            for (uint32_t index = current; index != NO_PARENT; index = grid->cells[index].parent) {
+                int pathRow, pathCol;
+                cellPosition(grid, index, &pathRow, &pathCol);
+                search->stats.pathLength++;
+                grid->cells[index].isPath = 1;
+                markDirty(grid, pathRow, pathCol);
+                traceCell(search, pathRow, pathCol, TRACE_PATH);
             }
+            endSearch(search, SEARCH_FOUND);
             break;
         }
-        neighbours.size = 0;
-        updateNeighbours(grid, &neighbours, currentCell, width, height);
+        int neighbourCount = updateNeighbours(grid, row, col, neighbours);
 
-        for (size_t i = 0; i < neighbours.size; i++) {
-            Cell* neighbourCell = neighbours.cells[i];
-            if (neighbourCell == NULL || contains(&close, neighbourCell) || neighbourCell->walkable == 0) {
+        for (int i = 0; i < neighbourCount; i++) {
+            int newRow = neighbours[i].row;
+            int newCol = neighbours[i].col;
+            size_t neighbour = cellIndex(grid, newRow, newCol);
+            Cell* neighbourCell = touchCell(grid, &grid->cells[neighbour]);
+            if (neighbourCell->isClosed) {
                 continue;
             }
 
-            int tentativeGCost = currentCell->gCost + heuristic(currentCell, neighbourCell);
-            if (tentativeGCost < neighbourCell->gCost || !contains(&open, neighbourCell)) {
+            int tentativeGCost = currentCell->gCost + heuristic(row, col, newRow, newCol);
+            if (tentativeGCost < neighbourCell->gCost || !neighbourCell->isOpen) {
                 neighbourCell->gCost = tentativeGCost;
-                neighbourCell->hCost = heuristic(neighbourCell, endCell);
-                neighbourCell->parent = currentCell;
-                if (!contains(&open, neighbourCell)) {
-                    push(&open, neighbourCell);
+                neighbourCell->hCost = heuristic(newRow, newCol, search->endRow, search->endCol);
+                neighbourCell->parent = current;
+                countHeat(grid, newRow, newCol);
+                pushOpen(open, (uint32_t)neighbour, neighbourCell->gCost + neighbourCell->hCost, neighbourCell->hCost);
+                if (open->size > search->stats.openPeak) {
+                    search->stats.openPeak = open->size;
+                }
+                if (!neighbourCell->isOpen) {
                     neighbourCell->isOpen = 1;
+                    markDirty(grid, newRow, newCol);
+                    traceCell(search, newRow, newCol, TRACE_OPEN);
                 }
             }
-            neighbours.cells[i] = NULL;
-            //render(renderer, grid, cursor, colors, width, height, rows, cols, spacing);
         }
+    }
+    if (search->status == SEARCH_RUNNING) {
+        noteArena(search);
+    }
+    search->stats.ticks += SDL_GetPerformanceCounter() - started;
+    return search->status;
+}
 
-        if (currentCell != endCell && open.size == 0) {
-            printf("No Solution Found");
+// Runs the search until it ends or the performance counter passes the
+// deadline, looking at the clock every few dozen expansions
+SearchStatus runSearch(Search *search, Uint64 deadline) {
+    while (stepSearch(search, 64) == SEARCH_RUNNING) {
+        if (SDL_GetPerformanceCounter() >= deadline) {
             break;
         }
-
-
     }
+    return search->status;
+}
 
+// Abandons a running search; what it found so far stays on the grid
+void stopSearch(Search *search) {
+    if (search->status == SEARCH_RUNNING) {
+        endSearch(search, SEARCH_IDLE);
+    }
+}
 
-    freeCellList(&open);
-    freeCellList(&close);
-    freeCellList(&neighbours);
-    freeCellList(&path);
-}
\ No newline at end of file
+// Runs a whole search in one go
+void astar(Grid *grid, Cell *startCell, Cell *endCell) {
+    Search search;
+    initSearch(&search);
+    startSearch(&search, grid, startCell, endCell);
+    stepSearch(&search, SIZE_MAX);
+}
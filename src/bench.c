@@ -0,0 +1,198 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+#include "arena.h"
+#include "bench.h"
+#include "config.h"
+#include "astar.h"
+#include "generate.h"
+#include "grid.h"
+#include "parallel.h"
+#include "render.h"
+#include "snapshot.h"
+
+// Headless benchmarks, run with `main --bench [rows] [cols] [runs] [density]`.
+// Every layout gets the same maps because the generators only see
+// (row, col) coordinates and are reseeded before each one.
+
+#define BENCH_SEED 1234
+// Frames are drawn by SDL's software renderer into a surface of this size
+#define RENDER_WIDTH 800
+#define RENDER_HEIGHT 800
+
+static const Color BENCH_COLORS[8] = {
+    {217, 132, 108, 255},
+    {60, 60, 60, 255},
+    {0, 0, 0, 255},
+    {0, 255, 0, 255},
+    {224, 93, 99, 255},
+    {227, 187, 41, 255},
+    {85, 130, 168, 255},
+    {70, 88, 104, 255}
+};
+
+static int countExpanded(const Grid *grid) {
+    int expanded = 0;
+    for (size_t i = 0; i < grid->cellCount; i++) {
+        expanded += inSearch(grid, &grid->cells[i]) && grid->cells[i].isClosed;
+    }
+    return expanded;
+}
+
+static double elapsedMs(Uint64 start) {
+    return (double)(SDL_GetPerformanceCounter() - start) * 1000.0 / (double)SDL_GetPerformanceFrequency();
+}
+
+static void benchmarkLayout(GridLayout layout, MapKind map, int rows, int cols, int runs, double density) {
+    Grid grid;
+    if (initGrid(&grid, rows, cols, layout) != 0) {
+        return;
+    }
+
+    Rng rng;
+    seedRng(&rng, BENCH_SEED);
+    Uint64 generateStart = SDL_GetPerformanceCounter();
+    generateMap(&grid, &rng, map, density, defaultThreadCount());
+    double generateMs = elapsedMs(generateStart);
+
+    Cell *startCell = firstWalkable(&grid);
+    Cell *endCell = lastWalkable(&grid);
+    if (startCell == NULL || endCell == NULL) {
+        freeGrid(&grid);
+        return;
+    }
+
+    // One untimed query lets the arena settle at its high-water mark, after
+    // which the timed queries should not malloc at all
+    Arena *arena = searchArena();
+    astar(&grid, startCell, endCell);
+    size_t mallocs = arena->blockMallocs;
+
+    double best = 0;
+    double total = 0;
+    for (int run = 0; run < runs; run++) {
+        Uint64 start = SDL_GetPerformanceCounter();
+        astar(&grid, startCell, endCell);
+        double ms = elapsedMs(start);
+        total += ms;
+        if (run == 0 || ms < best) {
+            best = ms;
+        }
+    }
+
+    printf("%-8s %-10s %10.3f ms best %10.3f ms mean %10d expanded %8zu KB arena %4zu mallocs %10.1f ms generate\n",
+           mapName(map), layoutName(layout), best, total / runs, countExpanded(&grid),
+           arena->highWater >> 10, arena->blockMallocs - mallocs, generateMs);
+    freeGrid(&grid);
+}
+
+// Frame time of drawing the grid, on a maze with a solved path so that
+// every colour shows up. Runs without a window, so it measures the CPU
+// side of submitting a frame.
+static void benchmarkRender(int rows, int cols, int runs) {
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, RENDER_WIDTH, RENDER_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = surface != NULL ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (renderer == NULL) {
+        fprintf(stderr, "Could not create software renderer: %s\n", SDL_GetError());
+        SDL_FreeSurface(surface);
+        return;
+    }
+
+    Grid grid;
+    SnapshotBuffer snapshots;
+    if (initGrid(&grid, rows, cols, LAYOUT_ROW_MAJOR) != 0) {
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+        return;
+    }
+    if (initSnapshots(&snapshots, rows, cols) != 0) {
+        freeGrid(&grid);
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+        return;
+    }
+
+    Rng rng;
+    seedRng(&rng, BENCH_SEED);
+    initializeMaze(&grid, &rng, defaultThreadCount());
+    Cell *startCell = firstWalkable(&grid);
+    Cell *endCell = lastWalkable(&grid);
+    startCell->isStartCell = 1;
+    endCell->isEndCell = 1;
+    astar(&grid, startCell, endCell);
+    publishSnapshot(&snapshots, &grid);
+
+    // Rect batches first, then the texture; its first frame uploads every
+    // texel and later ones only copy
+    GridTexture gridTexture;
+    int textureReady = initGridTexture(&gridTexture, renderer, rows, cols) == 0;
+    int width = RENDER_WIDTH;
+    int height = RENDER_HEIGHT;
+    int spacing = 2;
+    Camera camera;
+    fitCamera(&camera, width, height, rows, cols);
+    LodPyramid lod;
+    int lodReady = initLod(&lod, rows, cols) == 0;
+    if (lodReady) {
+        updateLod(&lod, acquireSnapshot(&snapshots));
+    }
+    for (int mode = 0; mode < 1 + textureReady; mode++) {
+        double best = 0;
+        double total = 0;
+        for (int run = 0; run < runs; run++) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            if (mode == 1) {
+                drawGridTexture(renderer, &gridTexture, acquireSnapshot(&snapshots), &camera, BENCH_COLORS, &width, &height, &spacing);
+            } else {
+                drawGrid(renderer, acquireSnapshot(&snapshots), lodReady ? &lod : NULL, &camera, BENCH_COLORS, &width, &height, &spacing);
+            }
+            // A batching renderer may only have queued the frame so far
+            SDL_RenderFlush(renderer);
+            double ms = elapsedMs(start);
+            total += ms;
+            if (run == 0 || ms < best) {
+                best = ms;
+            }
+        }
+        printf("render   %-10s %10.3f ms best %10.3f ms mean at %dx%d px\n",
+               mode == 1 ? "texture" : "rects", best, total / runs, width, height);
+    }
+    if (textureReady) {
+        freeGridTexture(&gridTexture);
+    }
+    if (lodReady) {
+        freeLod(&lod);
+    }
+
+    freeSnapshots(&snapshots);
+    freeGrid(&grid);
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+
+int runBenchmarks(int argc, char *argv[]) {
+    int rows = 256;
+    int cols = 0;
+    int runs = 5;
+    double density = 0.3;
+    if ((argc > 0 && parseInt(argv[0], 1, &rows) != 0) || (argc > 1 && parseInt(argv[1], 1, &cols) != 0)
+        || (argc > 2 && parseInt(argv[2], 1, &runs) != 0) || (argc > 3 && parseFraction(argv[3], &density) != 0) || argc > 4) {
+        fprintf(stderr, "Usage: main --bench [rows] [cols] [runs] [density]\n");
+        return 1;
+    }
+    if (cols == 0) {
+        cols = rows;
+    }
+
+    const GridLayout layouts[3] = {LAYOUT_ROW_MAJOR, LAYOUT_TILED, LAYOUT_MORTON};
+
+    printf("astar() on %dx%d, %d runs, random maps %.0f%% blocked, generated on %d threads\n",
+           rows, cols, runs, density * 100, defaultThreadCount());
+    for (int map = MAP_RANDOM; map <= MAP_DUNGEON; map++) {
+        for (int i = 0; i < 3; i++) {
+            benchmarkLayout(layouts[i], (MapKind)map, rows, cols, runs, density);
+        }
+    }
+    benchmarkRender(rows, cols, runs);
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "camera.h"
+
+
+// Whole grid in view and centred. Cells keep a whole number of pixels
+// while they are at least one pixel big, like before there was a camera.
+void fitCamera(Camera *camera, int width, int height, int rows, int cols) {
+    double fit = fmin((double)width / cols, (double)height / rows);
+    camera->scale = fit >= 1 ? floor(fit) : fit;
+    camera->minScale = fmin(camera->scale, fit * MIN_FIT_FRACTION);
+    camera->maxScale = fmax(camera->scale, MAX_CELL_PIXELS);
+    camera->x = (cols - width / camera->scale) / 2;
+    camera->y = (rows - height / camera->scale) / 2;
+    if (fit >= 1) {
+        // Grids that fit start at the top-left corner, as they always have
+        camera->x = 0;
+        camera->y = 0;
+    }
+}
+
+// Scales by factor while keeping the cell under (pixelX, pixelY) in place
+void zoomCamera(Camera *camera, double factor, int pixelX, int pixelY) {
+    double scale = fmax(camera->minScale, fmin(camera->maxScale, camera->scale * factor));
+    camera->x += pixelX / camera->scale - pixelX / scale;
+    camera->y += pixelY / camera->scale - pixelY / scale;
+    camera->scale = scale;
+}
+
+// Moves the view by a drag of (dx, dy) pixels
+void panCamera(Camera *camera, int dx, int dy) {
+    camera->x -= dx / camera->scale;
+    camera->y -= dy / camera->scale;
+}
+
+CellWindow visibleWindow(const Camera *camera, int width, int height, int rows, int cols) {
+    CellWindow view;
+    view.top = (int)fmax(0, floor(camera->y));
+    view.left = (int)fmax(0, floor(camera->x));
+    view.bottom = (int)fmin(rows, ceil(camera->y + height / camera->scale));
+    view.right = (int)fmin(cols, ceil(camera->x + width / camera->scale));
+    if (view.bottom < view.top) {
+        view.bottom = view.top;
+    }
+    if (view.right < view.left) {
+        view.right = view.left;
+    }
+    return view;
+}
+
+int sameView(const Camera *a, const Camera *b) {
+    return a->x == b->x && a->y == b->y && a->scale == b->scale;
+}
@@ -0,0 +1,206 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+#include "config.h"
+
+
+void defaultConfig(Config *config) {
+    config->width = 800;
+    config->height = 800;
+    config->rows = 50;
+    config->cols = 50;
+    config->spacing = 2;
+    config->layout = LAYOUT_ROW_MAJOR;
+    config->arenaSize = DEFAULT_ARENA_SIZE;
+    config->seed = 1;
+    config->density = 0.5;
+    config->threads = 0;
+    config->texture = 0;
+    config->searchBudget = 8;
+    config->trace = 0;
+    config->heat = 0;
+    config->hud = 0;
+}
+
+// Whole numbers from min up to 1 << 30
+int parseInt(const char *value, int min, int *out) {
+    char *end;
+    long parsed = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || parsed < min || parsed > 1 << 30) {
+        return -1;
+    }
+    *out = (int)parsed;
+    return 0;
+}
+
+// Byte counts with an optional K, M or G suffix
+static int parseSize(const char *value, size_t *out) {
+    char *end;
+    unsigned long long parsed = strtoull(value, &end, 10);
+    if (end == value || value[0] == '-') {
+        return -1;
+    }
+    switch (*end) {
+        case 'G': case 'g': parsed <<= 10; // fall through
+        case 'M': case 'm': parsed <<= 10; // fall through
+        case 'K': case 'k': parsed <<= 10; end++; break;
+        default: break;
+    }
+    if (*end != '\0' || parsed == 0) {
+        return -1;
+    }
+    *out = (size_t)parsed;
+    return 0;
+}
+
+int parseSeed(const char *value, uint64_t *out) {
+    char *end;
+    unsigned long long parsed = strtoull(value, &end, 0);
+    if (end == value || *end != '\0' || value[0] == '-') {
+        return -1;
+    }
+    *out = (uint64_t)parsed;
+    return 0;
+}
+
+// Numbers from 0 to 1
+int parseFraction(const char *value, double *out) {
+    char *end;
+    double parsed = strtod(value, &end);
+    if (end == value || *end != '\0' || parsed < 0 || parsed > 1) {
+        return -1;
+    }
+    *out = parsed;
+    return 0;
+}
+
+static int parseLayout(const char *value, GridLayout *out) {
+    if (strcmp(value, "row-major") == 0 || strcmp(value, "row") == 0) {
+        *out = LAYOUT_ROW_MAJOR;
+    } else if (strcmp(value, "tiled") == 0) {
+        *out = LAYOUT_TILED;
+    } else if (strcmp(value, "morton") == 0) {
+        *out = LAYOUT_MORTON;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+// Shared by the command line and config files, so both accept the same keys
+int setOption(Config *config, const char *key, const char *value) {
+    int result = -1;
+    if (strcmp(key, "rows") == 0) {
+        result = parseInt(value, 1, &config->rows);
+    } else if (strcmp(key, "cols") == 0) {
+        result = parseInt(value, 1, &config->cols);
+    } else if (strcmp(key, "size") == 0) {
+        result = parseInt(value, 1, &config->rows);
+        config->cols = config->rows;
+    } else if (strcmp(key, "width") == 0) {
+        result = parseInt(value, 1, &config->width);
+    } else if (strcmp(key, "height") == 0) {
+        result = parseInt(value, 1, &config->height);
+    } else if (strcmp(key, "spacing") == 0) {
+        result = parseInt(value, 0, &config->spacing);
+    } else if (strcmp(key, "layout") == 0) {
+        result = parseLayout(value, &config->layout);
+    } else if (strcmp(key, "arena") == 0) {
+        result = parseSize(value, &config->arenaSize);
+    } else if (strcmp(key, "seed") == 0) {
+        result = parseSeed(value, &config->seed);
+    } else if (strcmp(key, "density") == 0) {
+        result = parseFraction(value, &config->density);
+    } else if (strcmp(key, "threads") == 0) {
+        result = parseInt(value, 0, &config->threads);
+    } else if (strcmp(key, "texture") == 0) {
+        result = parseInt(value, 0, &config->texture);
+    } else if (strcmp(key, "budget") == 0) {
+        result = parseInt(value, 1, &config->searchBudget);
+    } else if (strcmp(key, "trace") == 0) {
+        result = parseInt(value, 0, &config->trace);
+    } else if (strcmp(key, "heat") == 0) {
+        result = parseInt(value, 0, &config->heat);
+    } else if (strcmp(key, "hud") == 0) {
+        result = parseInt(value, 0, &config->hud);
+    } else {
+        fprintf(stderr, "Unknown option '%s'\n", key);
+        return -1;
+    }
+
+    if (result != 0) {
+        fprintf(stderr, "Invalid value '%s' for '%s'\n", value, key);
+    }
+    return result;
+}
+
+// One "key = value" pair per line, '#' starts a comment
+int loadConfigFile(Config *config, const char *path) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open config file '%s'\n", path);
+        return -1;
+    }
+
+    char line[256];
+    int lineNumber = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        lineNumber++;
+        char key[64];
+        char value[128];
+        char *comment = strchr(line, '#');
+        if (comment != NULL) {
+            *comment = '\0';
+        }
+        for (char *c = line; *c != '\0'; c++) {
+            if (*c == '=') {
+                *c = ' ';
+            }
+        }
+
+        int fields = sscanf(line, "%63s %127s", key, value);
+        if (fields <= 0) {
+            continue;
+        }
+        if (fields != 2 || setOption(config, key, value) != 0) {
+            fprintf(stderr, "%s:%d: bad config line\n", path, lineNumber);
+            fclose(file);
+            return -1;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+int parseArgs(Config *config, int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0 || i + 1 >= argc) {
+            printUsage(argv[0]);
+            return -1;
+        }
+
+        const char *key = argv[i] + 2;
+        const char *value = argv[++i];
+        int result = strcmp(key, "config") == 0 ? loadConfigFile(config, value) : setOption(config, key, value);
+        if (result != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void printUsage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--config file] [--rows n] [--cols n] [--size n]\n"
+            "          [--width px] [--height px] [--spacing px] [--layout row-major|tiled|morton]\n"
+            "          [--arena bytes[K|M|G]] [--seed n] [--density 0..1]\n"
+            "          [--threads n] [--texture 0|1] [--budget ms] [--trace 0|1] [--heat 0|1] [--hud 0|1]\n"
+            "       %s --bench [rows] [cols] [runs] [density]\n"
+            "       %s --write-maze file.pbm rows cols [seed]\n"
+            "       %s --render file.ppm|file.png [rows] [cols] [map] [seed] [cell px]\n"
+            "       %s --record file.frames [rows] [cols] [map] [seed] [expansions per frame]\n"
+            "       %s --play file.frames prefix [cell px]\n",
+            program, program, program, program, program, program);
+}
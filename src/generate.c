@@ -0,0 +1,739 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "generate.h"
+#include "parallel.h"
+
+
+// Union-find over maze sets: tiles, or the labels of a row of nodes
+static int findSet(int *parent, int label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+// Density as a fraction of 256, the resolution randomMask() works at
+unsigned int densityThreshold(double density) {
+    if (density <= 0) {
+        return 0;
+    } else if (density >= 1) {
+        return 256;
+    }
+    return (unsigned int)(density * 256.0 + 0.5);
+}
+
+// Returns a word whose bits are each set with probability threshold/256.
+// Starting from an empty mask, OR-ing in a random word maps p to (1 + p) / 2
+// and AND-ing maps it to p / 2, so walking the threshold's binary digits from
+// the lowest set one up builds it exactly, with at most 8 random words.
+uint64_t randomMask(Rng *rng, unsigned int threshold) {
+    if (threshold == 0) {
+        return 0;
+    } else if (threshold >= 256) {
+        return ~(uint64_t)0;
+    }
+
+    uint64_t mask = 0;
+    int bit = 0;
+    while (!((threshold >> bit) & 1)) {
+        bit++;
+    }
+    for (; bit < 8; bit++) {
+        uint64_t random = nextRandom(rng);
+        mask = (threshold >> bit) & 1 ? (mask | random) : (mask & random);
+    }
+    return mask;
+}
+
+// Rows per random fill band; each band draws from its own RNG stream
+#define FILL_BAND_ROWS 64
+// Caves start as noise with this share of walls, then get smoothed
+#define CAVE_FILL 0.45
+#define CAVE_SMOOTHING 5
+// Dungeons get one room per sector of about this many cells square
+#define DUNGEON_SECTOR 24
+// Maze tiles are 64x64 nodes, 128x128 cells: a whole number of bitmap
+// words, so tiles carved on different threads never write the same word
+#define MAZE_TILE_CELLS 128
+
+typedef struct {
+    Grid *grid;
+    uint64_t seed;
+    unsigned int threshold;
+} FillJob;
+
+static void fillBand(void *context, int band) {
+    FillJob *job = (FillJob *)context;
+    Grid *grid = job->grid;
+    Rng rng;
+    seedRngStream(&rng, job->seed, (uint64_t)band);
+
+    int last = SDL_min((band + 1) * FILL_BAND_ROWS, grid->rows);
+    for (int row = band * FILL_BAND_ROWS; row < last; row++) {
+        uint64_t *words = walkableRow(grid, row);
+        for (size_t i = 0; i < grid->wordsPerRow; i++) {
+            words[i] = ~randomMask(&rng, job->threshold);
+        }
+        words[grid->wordsPerRow - 1] &= lastWordMask(grid);
+    }
+}
+
+// Fills the walkability layer 64 cells at a time; `density` is the share
+// of blocked cells. Only the bitmap is written, earlier search results are
+// retired by starting a new search id instead of sweeping the cells.
+// Bands of rows are filled in parallel from streams of one seed drawn from
+// rng, so the result does not depend on the thread count.
+void randomizeGrid(Grid *grid, Rng *rng, double density, int threads) {
+    FillJob job;
+    job.grid = grid;
+    job.seed = nextRandom(rng);
+    job.threshold = densityThreshold(density);
+
+    runTiles((grid->rows + FILL_BAND_ROWS - 1) / FILL_BAND_ROWS, threads, fillBand, &job);
+    beginSearch(grid);
+}
+
+
+// Depth-first carving from (row, col) with an explicit stack of cell indices
+// instead of recursion, so the depth is only bounded by the region size.
+// Maze nodes sit on even rows and columns and start out as walls, which
+// means a node is visited exactly when it is walkable; no separate visited
+// flags needed. Nothing outside region is written.
+void generateMaze(Grid *grid, Rng *rng, const MazeRegion *region, int row, int col) {
+    // Direction vectors for moving in 4 directions
+    const int directions[4][2] = {
+        {0, 1}, // Right
+        {1, 0}, // Down
+        {0, -1}, // Left
+        {-1, 0} // Up
+    };
+
+    int width = region->right - region->left;
+    if ((size_t)(region->bottom - region->top) * width > UINT32_MAX) {
+        fprintf(stderr, "Grid too large for 32-bit maze indices\n");
+        return;
+    }
+
+    // Every node is pushed at most once
+    size_t nodes = (size_t)((region->bottom - region->top + 1) / 2) * ((width + 1) / 2);
+    uint32_t *stack = (uint32_t *)malloc(nodes * sizeof(uint32_t));
+    if (stack == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return;
+    }
+
+    size_t top = 0;
+    stack[top++] = (uint32_t)(row - region->top) * width + (col - region->left);
+    setWalkable(grid, row, col, 1);
+
+    while (top > 0) {
+        uint32_t current = stack[top - 1];
+        row = region->top + (int)(current / width);
+        col = region->left + (int)(current % width);
+
+        int candidates[4];
+        int count = 0;
+        for (int i = 0; i < 4; i++) {
+            int newRow = row + directions[i][0] * 2;
+            int newCol = col + directions[i][1] * 2;
+            if (newRow >= region->top && newRow < region->bottom && newCol >= region->left && newCol < region->right
+                && !isWalkable(grid, newRow, newCol)) {
+                candidates[count++] = i;
+            }
+        }
+
+        if (count == 0) {
+            top--;
+            continue;
+        }
+
+        int i = candidates[randomBelow(rng, count)];
+        int newRow = row + directions[i][0] * 2;
+        int newCol = col + directions[i][1] * 2;
+        setWalkable(grid, row + directions[i][0], col + directions[i][1], 1);
+        setWalkable(grid, newRow, newCol, 1);
+        stack[top++] = (uint32_t)(newRow - region->top) * width + (newCol - region->left);
+    }
+
+    free(stack);
+}
+
+
+typedef struct {
+    Grid *grid;
+    uint64_t seed;
+    int tileRows;
+    int tileCols;
+} MazeJob;
+
+static MazeRegion mazeTileRegion(const MazeJob *job, int tile) {
+    MazeRegion region;
+    region.top = (tile / job->tileCols) * MAZE_TILE_CELLS;
+    region.left = (tile % job->tileCols) * MAZE_TILE_CELLS;
+    region.bottom = SDL_min(region.top + MAZE_TILE_CELLS, job->grid->rows);
+    region.right = SDL_min(region.left + MAZE_TILE_CELLS, job->grid->cols);
+    return region;
+}
+
+// A random node row or column between start (even) and end
+static int randomNode(Rng *rng, int start, int end) {
+    return start + 2 * (int)randomBelow(rng, (uint32_t)((end - start + 1) / 2));
+}
+
+static void carveMazeTile(void *context, int tile) {
+    MazeJob *job = (MazeJob *)context;
+    MazeRegion region = mazeTileRegion(job, tile);
+    Rng rng;
+    seedRngStream(&rng, job->seed, (uint64_t)tile);
+
+    int row = randomNode(&rng, region.top, region.bottom);
+    int col = randomNode(&rng, region.left, region.right);
+    generateMaze(job->grid, &rng, &region, row, col);
+}
+
+// Joins the separately carved tiles into one perfect maze: a random spanning
+// tree over the tile adjacency graph (Kruskal over shuffled edges), opening a
+// single passage through the wall between each pair of tiles it links.
+static void stitchMazeTiles(const MazeJob *job) {
+    int tiles = job->tileRows * job->tileCols;
+    int horizontal = job->tileRows * (job->tileCols - 1);
+    int edgeCount = horizontal + (job->tileRows - 1) * job->tileCols;
+    if (edgeCount == 0) {
+        return;
+    }
+
+    int *edges = (int *)malloc(edgeCount * sizeof(int));
+    int *parent = (int *)malloc(tiles * sizeof(int));
+    if (edges == NULL || parent == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(edges);
+        free(parent);
+        return;
+    }
+
+    // The stream after the last tile's belongs to the stitch pass
+    Rng rng;
+    seedRngStream(&rng, job->seed, (uint64_t)tiles);
+    for (int i = 0; i < edgeCount; i++) {
+        edges[i] = i;
+    }
+    for (int i = edgeCount - 1; i > 0; i--) {
+        int j = (int)randomBelow(&rng, (uint32_t)i + 1);
+        int swap = edges[i];
+        edges[i] = edges[j];
+        edges[j] = swap;
+    }
+    for (int i = 0; i < tiles; i++) {
+        parent[i] = i;
+    }
+
+    for (int i = 0; i < edgeCount; i++) {
+        // Edges below `horizontal` link a tile to its right neighbour,
+        // the rest link a tile to the one below
+        int edge = edges[i];
+        int tile = edge < horizontal
+            ? (edge / (job->tileCols - 1)) * job->tileCols + edge % (job->tileCols - 1)
+            : edge - horizontal;
+        int other = tile + (edge < horizontal ? 1 : job->tileCols);
+
+        int a = findSet(parent, tile);
+        int b = findSet(parent, other);
+        if (a == b) {
+            continue;
+        }
+        parent[b] = a;
+
+        MazeRegion region = mazeTileRegion(job, tile);
+        if (edge < horizontal) {
+            setWalkable(job->grid, randomNode(&rng, region.top, region.bottom), region.right - 1, 1);
+        } else {
+            setWalkable(job->grid, region.bottom - 1, randomNode(&rng, region.left, region.right), 1);
+        }
+    }
+
+    free(edges);
+    free(parent);
+}
+
+// Carves the maze tile by tile on up to `threads` threads, then stitches the
+// tiles together. Every tile has its own RNG stream, so a seed gives the
+// same maze on any number of threads.
+void initializeMaze(Grid *grid, Rng *rng, int threads) {
+    setAllWalkable(grid, 0);
+    // Paths from an earlier search no longer apply
+    beginSearch(grid);
+
+    MazeJob job;
+    job.grid = grid;
+    job.seed = nextRandom(rng);
+    job.tileRows = (grid->rows + MAZE_TILE_CELLS - 1) / MAZE_TILE_CELLS;
+    job.tileCols = (grid->cols + MAZE_TILE_CELLS - 1) / MAZE_TILE_CELLS;
+
+    runTiles(job.tileRows * job.tileCols, threads, carveMazeTile, &job);
+    stitchMazeTiles(&job);
+}
+
+
+typedef struct {
+    const Grid *grid;
+    const uint64_t *source;  // walkability before this pass
+    uint64_t *target;
+} SmoothJob;
+
+// Adds one bit per lane to the 4-bit counters sum[0..3]
+static inline void addBits(uint64_t sum[4], uint64_t bits) {
+    for (int i = 0; i < 4 && bits != 0; i++) {
+        uint64_t carry = sum[i] & bits;
+        sum[i] ^= bits;
+        bits = carry;
+    }
+}
+
+// One cellular automaton step on a band of rows: a cell becomes wall when
+// at least 5 of the 9 cells around and including it are walls, anything
+// outside the grid counting as wall. The 64 cells of a word are counted at
+// once with bit-sliced adders over the shifted neighbour words.
+static void smoothBand(void *context, int band) {
+    SmoothJob *job = (SmoothJob *)context;
+    const Grid *grid = job->grid;
+    size_t words = grid->wordsPerRow;
+
+    int last = SDL_min((band + 1) * FILL_BAND_ROWS, grid->rows);
+    for (int row = band * FILL_BAND_ROWS; row < last; row++) {
+        const uint64_t *rows[3];
+        for (int i = 0; i < 3; i++) {
+            int r = row + i - 1;
+            rows[i] = r >= 0 && r < grid->rows ? &job->source[(size_t)r * words] : NULL;
+        }
+
+        for (size_t w = 0; w < words; w++) {
+            uint64_t sum[4] = {0, 0, 0, 0};
+            for (int i = 0; i < 3; i++) {
+                if (rows[i] == NULL) {
+                    addBits(sum, ~(uint64_t)0);
+                    addBits(sum, ~(uint64_t)0);
+                    addBits(sum, ~(uint64_t)0);
+                    continue;
+                }
+                // Walls are the clear bits, padding past cols included
+                uint64_t wall = ~rows[i][w];
+                uint64_t before = w > 0 ? ~rows[i][w - 1] : ~(uint64_t)0;
+                uint64_t after = w + 1 < words ? ~rows[i][w + 1] : ~(uint64_t)0;
+                addBits(sum, wall);
+                addBits(sum, wall << 1 | before >> 63);
+                addBits(sum, wall >> 1 | after << 63);
+            }
+            uint64_t solid = sum[3] | (sum[2] & (sum[1] | sum[0]));
+            job->target[(size_t)row * words + w] = ~solid;
+        }
+        job->target[(size_t)row * words + words - 1] &= lastWordMask(grid);
+    }
+}
+
+static inline int isSeen(const Grid *grid, const uint64_t *seen, int row, int col) {
+    return (int)(seen[(size_t)row * grid->wordsPerRow + (col >> 6)] >> (col & 63)) & 1;
+}
+
+// Marks the cave around start in `seen` and returns its size in cells
+static size_t floodCave(const Grid *grid, uint32_t start, uint32_t *queue, uint64_t *seen) {
+    const int directions[4][2] = {{0, 1}, {1, 0}, {0, -1}, {-1, 0}};
+    size_t head = 0;
+    size_t tail = 0;
+    queue[tail++] = start;
+    seen[(size_t)(start / grid->cols) * grid->wordsPerRow + ((start % grid->cols) >> 6)] |= (uint64_t)1 << ((start % grid->cols) & 63);
+
+    while (head < tail) {
+        uint32_t current = queue[head++];
+        int row = (int)(current / grid->cols);
+        int col = (int)(current % grid->cols);
+        for (int i = 0; i < 4; i++) {
+            int newRow = row + directions[i][0];
+            int newCol = col + directions[i][1];
+            if (newRow >= 0 && newRow < grid->rows && newCol >= 0 && newCol < grid->cols
+                && isWalkable(grid, newRow, newCol) && !isSeen(grid, seen, newRow, newCol)) {
+                seen[(size_t)newRow * grid->wordsPerRow + (newCol >> 6)] |= (uint64_t)1 << (newCol & 63);
+                queue[tail++] = (uint32_t)newRow * grid->cols + newCol;
+            }
+        }
+    }
+    return tail;
+}
+
+// Fills every walkable cell that is not connected to the largest cave, so
+// any two open cells of a cave map have a path between them
+static void keepLargestCave(Grid *grid) {
+    size_t cells = (size_t)grid->rows * grid->cols;
+    if (cells > UINT32_MAX) {
+        fprintf(stderr, "Grid too large for 32-bit cave indices\n");
+        return;
+    }
+
+    size_t words = (size_t)grid->rows * grid->wordsPerRow;
+    uint32_t *queue = (uint32_t *)malloc(cells * sizeof(uint32_t));
+    uint64_t *seen = (uint64_t *)calloc(words, sizeof(uint64_t));
+    if (queue == NULL || seen == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(queue);
+        free(seen);
+        return;
+    }
+
+    size_t best = 0;
+    uint32_t bestStart = 0;
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
+            if (isWalkable(grid, row, col) && !isSeen(grid, seen, row, col)) {
+                uint32_t start = (uint32_t)row * grid->cols + col;
+                size_t size = floodCave(grid, start, queue, seen);
+                if (size > best) {
+                    best = size;
+                    bestStart = start;
+                }
+            }
+        }
+    }
+
+    // Flood the winner again on its own; that is exactly the new bitmap
+    if (best > 0) {
+        memset(seen, 0, words * sizeof(uint64_t));
+        floodCave(grid, bestStart, queue, seen);
+        memcpy(grid->walkable, seen, words * sizeof(uint64_t));
+    }
+    free(queue);
+    free(seen);
+}
+
+// Cave maps: random noise smoothed into caverns by a cellular automaton
+// run on the bitmap a word at a time, bands of rows in parallel. Each pass
+// reads one buffer and writes the other, so bands never see each other's
+// output and the result does not depend on the thread count.
+void generateCaves(Grid *grid, Rng *rng, int threads) {
+    randomizeGrid(grid, rng, CAVE_FILL, threads);
+
+    size_t words = (size_t)grid->rows * grid->wordsPerRow;
+    uint64_t *scratch = (uint64_t *)malloc(words * sizeof(uint64_t));
+    if (scratch == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return;
+    }
+
+    SmoothJob job;
+    job.grid = grid;
+    for (int pass = 0; pass < CAVE_SMOOTHING; pass++) {
+        job.source = grid->walkable;
+        job.target = scratch;
+        runTiles((grid->rows + FILL_BAND_ROWS - 1) / FILL_BAND_ROWS, threads, smoothBand, &job);
+        scratch = grid->walkable;
+        grid->walkable = job.target;
+    }
+    free(scratch);
+
+    keepLargestCave(grid);
+}
+
+
+// Picks a room span inside a sector span, keeping a wall on either side
+// whenever the sector is big enough for one
+static void roomSpan(Rng *rng, int start, int length, int *roomStart, int *roomLength) {
+    int margin = length >= 3 ? 1 : 0;
+    int usable = length - 2 * margin;
+    int minimum = SDL_min(3, usable);
+    *roomLength = minimum + (int)randomBelow(rng, (uint32_t)(usable - minimum + 1));
+    *roomStart = start + margin + (int)randomBelow(rng, (uint32_t)(usable - *roomLength + 1));
+}
+
+static void carveRect(Grid *grid, int top, int left, int bottom, int right) {
+    for (int row = top; row < bottom; row++) {
+        for (int col = left; col < right; col++) {
+            setWalkable(grid, row, col, 1);
+        }
+    }
+}
+
+// L-shaped corridor between two points, turning at a random corner
+static void carveCorridor(Grid *grid, Rng *rng, int row, int col, int toRow, int toCol) {
+    int turnRow = row;
+    int turnCol = toCol;
+    if (nextRandom(rng) & 1) {
+        turnRow = toRow;
+        turnCol = col;
+    }
+    carveRect(grid, SDL_min(row, turnRow), SDL_min(col, turnCol), SDL_max(row, turnRow) + 1, SDL_max(col, turnCol) + 1);
+    carveRect(grid, SDL_min(turnRow, toRow), SDL_min(turnCol, toCol), SDL_max(turnRow, toRow) + 1, SDL_max(turnCol, toCol) + 1);
+}
+
+// Rooms and corridors: one random room per sector of the grid. Rooms are
+// joined to their right neighbour along every sector row and down the first
+// sector column, which connects them all, and a quarter of the other
+// vertical neighbours get a corridor too so that the map has loops.
+void generateDungeon(Grid *grid, Rng *rng) {
+    setAllWalkable(grid, 0);
+    beginSearch(grid);
+
+    int sectorRows = SDL_max(1, grid->rows / DUNGEON_SECTOR);
+    int sectorCols = SDL_max(1, grid->cols / DUNGEON_SECTOR);
+    int *centres = (int *)malloc((size_t)sectorRows * sectorCols * 2 * sizeof(int));
+    if (centres == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return;
+    }
+
+    for (int sr = 0; sr < sectorRows; sr++) {
+        // Spread the remainder so sectors cover the whole grid
+        int top = (int)((long long)sr * grid->rows / sectorRows);
+        int height = (int)((long long)(sr + 1) * grid->rows / sectorRows) - top;
+        for (int sc = 0; sc < sectorCols; sc++) {
+            int left = (int)((long long)sc * grid->cols / sectorCols);
+            int width = (int)((long long)(sc + 1) * grid->cols / sectorCols) - left;
+
+            int roomTop, roomHeight, roomLeft, roomWidth;
+            roomSpan(rng, top, height, &roomTop, &roomHeight);
+            roomSpan(rng, left, width, &roomLeft, &roomWidth);
+            carveRect(grid, roomTop, roomLeft, roomTop + roomHeight, roomLeft + roomWidth);
+
+            int *centre = &centres[((size_t)sr * sectorCols + sc) * 2];
+            centre[0] = roomTop + (int)randomBelow(rng, (uint32_t)roomHeight);
+            centre[1] = roomLeft + (int)randomBelow(rng, (uint32_t)roomWidth);
+        }
+    }
+
+    for (int sr = 0; sr < sectorRows; sr++) {
+        for (int sc = 0; sc < sectorCols; sc++) {
+            int *centre = &centres[((size_t)sr * sectorCols + sc) * 2];
+            if (sc + 1 < sectorCols) {
+                int *right = centre + 2;
+                carveCorridor(grid, rng, centre[0], centre[1], right[0], right[1]);
+            }
+            if (sr + 1 < sectorRows && (sc == 0 || randomBelow(rng, 4) == 0)) {
+                int *below = &centres[((size_t)(sr + 1) * sectorCols + sc) * 2];
+                carveCorridor(grid, rng, centre[0], centre[1], below[0], below[1]);
+            }
+        }
+    }
+
+    free(centres);
+}
+
+
+// Eller's algorithm: produces a perfect maze one row at a time, keeping only
+// the set labels of the current row of nodes. Nodes sit on even rows and
+// columns like generateMaze(). Each finished grid row is handed to sink as
+// walkability bits, so the whole maze never has to exist in memory.
+int generateEllerMaze(Rng *rng, int rows, int cols, MazeRowSink sink, void *context) {
+    int nodeRows = (rows + 1) / 2;
+    int nodeCols = (cols + 1) / 2;
+    size_t words = ((size_t)cols + 63) >> 6;
+
+    int *set = (int *)malloc(nodeCols * sizeof(int));
+    int *parent = (int *)malloc(nodeCols * sizeof(int));
+    int *remap = (int *)malloc(nodeCols * sizeof(int));
+    int *pending = (int *)malloc(nodeCols * sizeof(int));   // members of a set still without a way down
+    unsigned char *down = (unsigned char *)malloc(nodeCols);
+    uint64_t *bits = (uint64_t *)malloc(words * sizeof(uint64_t));
+    int result = -1;
+    if (set == NULL || parent == NULL || remap == NULL || pending == NULL || down == NULL || bits == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        goto done;
+    }
+
+    for (int c = 0; c < nodeCols; c++) {
+        set[c] = c;
+    }
+
+    for (int r = 0; r < nodeRows; r++) {
+        int lastRow = r == nodeRows - 1;
+        for (int c = 0; c < nodeCols; c++) {
+            parent[c] = c;
+        }
+
+        // Node row: join neighbours from different sets at random, and all of
+        // them on the last row so everything ends up connected
+        memset(bits, 0, words * sizeof(uint64_t));
+        for (int c = 0; c < nodeCols; c++) {
+            bits[(2 * c) >> 6] |= (uint64_t)1 << ((2 * c) & 63);
+            if (c + 1 < nodeCols) {
+                int a = findSet(parent, set[c]);
+                int b = findSet(parent, set[c + 1]);
+                if (a != b && (lastRow || (nextRandom(rng) & 1))) {
+                    parent[b] = a;
+                    bits[(2 * c + 1) >> 6] |= (uint64_t)1 << ((2 * c + 1) & 63);
+                }
+            }
+        }
+        if (sink(context, 2 * r, bits, cols) != 0) {
+            goto done;
+        }
+        if (2 * r + 1 >= rows) {
+            break;
+        }
+
+        // Passage row: every set needs at least one way down
+        memset(bits, 0, words * sizeof(uint64_t));
+        if (!lastRow) {
+            for (int c = 0; c < nodeCols; c++) {
+                pending[c] = 0;
+            }
+            for (int c = 0; c < nodeCols; c++) {
+                set[c] = findSet(parent, set[c]);
+                down[c] = nextRandom(rng) & 1;
+                if (down[c]) {
+                    pending[set[c]] = -1;
+                } else if (pending[set[c]] >= 0) {
+                    pending[set[c]]++;
+                }
+            }
+            // Sets that drew no way down open one member picked at random
+            for (int c = 0; c < nodeCols; c++) {
+                int label = set[c];
+                if (pending[label] > 0 && randomBelow(rng, pending[label]) == 0) {
+                    down[c] = 1;
+                    pending[label] = -1;
+                } else if (pending[label] > 0) {
+                    pending[label]--;
+                }
+            }
+
+            // Carry sets down; nodes without a way down start new sets, and
+            // labels are renumbered so they stay below nodeCols
+            int next = 0;
+            for (int c = 0; c < nodeCols; c++) {
+                remap[c] = -1;
+            }
+            for (int c = 0; c < nodeCols; c++) {
+                if (down[c]) {
+                    bits[(2 * c) >> 6] |= (uint64_t)1 << ((2 * c) & 63);
+                    if (remap[set[c]] < 0) {
+                        remap[set[c]] = next++;
+                    }
+                }
+            }
+            for (int c = 0; c < nodeCols; c++) {
+                set[c] = down[c] ? remap[set[c]] : next++;
+            }
+        }
+        if (sink(context, 2 * r + 1, bits, cols) != 0) {
+            goto done;
+        }
+    }
+    result = 0;
+
+done:
+    free(set);
+    free(parent);
+    free(remap);
+    free(pending);
+    free(down);
+    free(bits);
+    return result;
+}
+
+int gridRowSink(void *context, int row, const uint64_t *bits, int cols) {
+    Grid *grid = (Grid *)context;
+    (void)cols;
+    memcpy(walkableRow(grid, row), bits, grid->wordsPerRow * sizeof(uint64_t));
+    return 0;
+}
+
+void initializeEllerMaze(Grid *grid, Rng *rng) {
+    beginSearch(grid);
+    generateEllerMaze(rng, grid->rows, grid->cols, gridRowSink, grid);
+}
+
+
+typedef struct {
+    FILE *file;
+    uint8_t *bytes;
+    size_t rowBytes;
+} PbmWriter;
+
+// PBM rows are packed MSB first with 1 meaning black, used here for walls
+static int pbmRowSink(void *context, int row, const uint64_t *bits, int cols) {
+    PbmWriter *writer = (PbmWriter *)context;
+    (void)row;
+    memset(writer->bytes, 0, writer->rowBytes);
+    for (int col = 0; col < cols; col++) {
+        if (!((bits[col >> 6] >> (col & 63)) & 1)) {
+            writer->bytes[col >> 3] |= (uint8_t)(0x80 >> (col & 7));
+        }
+    }
+    return fwrite(writer->bytes, 1, writer->rowBytes, writer->file) == writer->rowBytes ? 0 : -1;
+}
+
+// Streams an Eller maze straight to a binary PBM file, without a grid
+int writeMazeFile(const char *path, int rows, int cols, uint64_t seed) {
+    if (rows <= 0 || cols <= 0) {
+        fprintf(stderr, "Invalid maze size %dx%d\n", rows, cols);
+        return -1;
+    }
+
+    PbmWriter writer;
+    writer.file = fopen(path, "wb");
+    if (writer.file == NULL) {
+        fprintf(stderr, "Could not open '%s' for writing\n", path);
+        return -1;
+    }
+    writer.rowBytes = ((size_t)cols + 7) / 8;
+    writer.bytes = (uint8_t *)malloc(writer.rowBytes);
+    if (writer.bytes == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        fclose(writer.file);
+        return -1;
+    }
+
+    Rng rng;
+    seedRng(&rng, seed);
+    fprintf(writer.file, "P4\n%d %d\n", cols, rows);
+    int result = generateEllerMaze(&rng, rows, cols, pbmRowSink, &writer);
+
+    free(writer.bytes);
+    if (fclose(writer.file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+static const char *MAP_NAMES[] = {"random", "maze", "cave", "dungeon"};
+
+// Random maps open up the corners so start and end sit in the big component
+static void clearCorners(Grid *grid) {
+    for (int row = 0; row < 8 && row < grid->rows; row++) {
+        for (int col = 0; col < 8 && col < grid->cols; col++) {
+            setWalkable(grid, row, col, 1);
+            setWalkable(grid, grid->rows - 1 - row, grid->cols - 1 - col, 1);
+        }
+    }
+}
+
+// Maps for headless runs, where start and end go on the first and last
+// walkable cells
+void generateMap(Grid *grid, Rng *rng, MapKind map, double density, int threads) {
+    if (map == MAP_MAZE) {
+        initializeMaze(grid, rng, threads);
+    } else if (map == MAP_CAVE) {
+        generateCaves(grid, rng, threads);
+    } else if (map == MAP_DUNGEON) {
+        generateDungeon(grid, rng);
+    } else {
+        randomizeGrid(grid, rng, density, threads);
+        clearCorners(grid);
+    }
+}
+
+const char* mapName(MapKind map) {
+    return MAP_NAMES[map];
+}
+
+int parseMap(const char *name, MapKind *map) {
+    for (int i = MAP_RANDOM; i <= MAP_DUNGEON; i++) {
+        if (strcmp(name, MAP_NAMES[i]) == 0) {
+            *map = (MapKind)i;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown map '%s'\n", name);
+    return -1;
+}
@@ -0,0 +1,165 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "grid.h"
+
+
+int initGrid(Grid *grid, int rows, int cols, GridLayout layout) {
+    grid->rows = rows;
+    grid->cols = cols;
+    grid->layout = layout;
+    grid->search = 0;
+    grid->heat = NULL;
+    grid->tilesPerRow = (cols + TILE_MASK) >> TILE_SHIFT;
+
+    if (layout == LAYOUT_ROW_MAJOR) {
+        grid->cellCount = (size_t)rows * cols;
+    } else {
+        // Pad to whole tiles so every cellIndex() lands inside the allocation
+        size_t tileRows = (size_t)(rows + TILE_MASK) >> TILE_SHIFT;
+        grid->cellCount = tileRows * grid->tilesPerRow * TILE_SIZE * TILE_SIZE;
+    }
+    // Parents are 32-bit cell indices with NO_PARENT kept free
+    if (grid->cellCount >= NO_PARENT) {
+        fprintf(stderr, "Grid of %dx%d cells is too large\n", rows, cols);
+        grid->cells = NULL;
+        grid->walkable = NULL;
+        grid->dirty.cells = NULL;
+        grid->dirty.marked = NULL;
+        grid->heat = NULL;
+        return -1;
+    }
+
+    grid->wordsPerRow = ((size_t)cols + 63) >> 6;
+    grid->cells = (Cell *)calloc(grid->cellCount, sizeof(Cell));
+    grid->walkable = (uint64_t *)malloc((size_t)rows * grid->wordsPerRow * sizeof(uint64_t));
+    grid->dirty.capacity = dirtyLimit(rows, cols);
+    grid->dirty.count = 0;
+    grid->dirty.all = 1;
+    grid->dirty.cells = (uint32_t *)malloc((grid->dirty.capacity + 1) * sizeof(uint32_t));
+    grid->dirty.marked = (uint64_t *)calloc((size_t)rows * grid->wordsPerRow, sizeof(uint64_t));
+    if (grid->cells == NULL || grid->walkable == NULL || grid->dirty.cells == NULL || grid->dirty.marked == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        freeGrid(grid);
+        return -1;
+    }
+    setAllWalkable(grid, 1);
+    return 0;
+}
+
+void freeGrid(Grid *grid) {
+    if (grid->cells != NULL) {
+        free(grid->cells);
+        grid->cells = NULL;
+    }
+    if (grid->walkable != NULL) {
+        free(grid->walkable);
+        grid->walkable = NULL;
+    }
+    free(grid->dirty.cells);
+    free(grid->dirty.marked);
+    grid->dirty.cells = NULL;
+    grid->dirty.marked = NULL;
+    disableHeat(grid);
+}
+
+// Starts counting search work per cell from zero. The counts add up over
+// every search until disableHeat().
+int enableHeat(Grid *grid) {
+    if (grid->heat != NULL) {
+        return 0;
+    }
+    grid->heat = (uint16_t *)calloc((size_t)grid->rows * grid->cols, sizeof(uint16_t));
+    if (grid->heat == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return -1;
+    }
+    markAllDirty(grid);
+    return 0;
+}
+
+void disableHeat(Grid *grid) {
+    if (grid->heat != NULL) {
+        free(grid->heat);
+        grid->heat = NULL;
+        markAllDirty(grid);
+    }
+}
+
+void markAllDirty(Grid *grid) {
+    grid->dirty.all = 1;
+}
+
+// Called once the dirty cells have been published
+void clearDirty(Grid *grid) {
+    DirtySet *dirty = &grid->dirty;
+    if (dirty->all) {
+        memset(dirty->marked, 0, (size_t)grid->rows * grid->wordsPerRow * sizeof(uint64_t));
+    } else {
+        for (size_t i = 0; i < dirty->count; i++) {
+            int row = (int)(dirty->cells[i] / grid->cols);
+            int col = (int)(dirty->cells[i] % grid->cols);
+            dirty->marked[(size_t)row * grid->wordsPerRow + (col >> 6)] = 0;
+        }
+    }
+    dirty->count = 0;
+    dirty->all = 0;
+}
+
+void setAllWalkable(Grid *grid, int walkable) {
+    uint64_t fill = walkable ? ~(uint64_t)0 : 0;
+    for (int row = 0; row < grid->rows; row++) {
+        uint64_t *words = walkableRow(grid, row);
+        for (size_t i = 0; i < grid->wordsPerRow; i++) {
+            words[i] = fill;
+        }
+        words[grid->wordsPerRow - 1] &= lastWordMask(grid);
+    }
+    markAllDirty(grid);
+}
+
+// Starting a search only bumps the id; cells catch up in touchCell().
+// Whatever the last search showed goes away, so everything is dirty.
+void beginSearch(Grid *grid) {
+    markAllDirty(grid);
+    if (grid->search == MAX_SEARCH_ID) {
+        for (size_t i = 0; i < grid->cellCount; i++) {
+            grid->cells[i].search = 0;
+        }
+        grid->search = 0;
+    }
+    grid->search++;
+}
+
+const char* layoutName(GridLayout layout) {
+    switch (layout) {
+        case LAYOUT_TILED:
+            return "tiled";
+        case LAYOUT_MORTON:
+            return "morton";
+        default:
+            return "row-major";
+    }
+}
+
+Cell* firstWalkable(const Grid *grid) {
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
+            if (isWalkable(grid, row, col)) {
+                return getCell(grid, row, col);
+            }
+        }
+    }
+    return NULL;
+}
+
+Cell* lastWalkable(const Grid *grid) {
+    for (int row = grid->rows - 1; row >= 0; row--) {
+        for (int col = grid->cols - 1; col >= 0; col--) {
+            if (isWalkable(grid, row, col)) {
+                return getCell(grid, row, col);
+            }
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,79 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "astar.h"
+#include "config.h"
+#include "generate.h"
+#include "grid.h"
+#include "headless.h"
+#include "image.h"
+#include "parallel.h"
+#include "snapshot.h"
+
+// Images of solved maps for machines without a display, run with
+// `main --render file.ppm|file.png [rows] [cols] [map] [seed] [cell px]`.
+// Nothing here touches SDL's video subsystem.
+
+#define IMAGE_DENSITY 0.3
+
+
+int runHeadless(int argc, char *argv[], const Color* colors) {
+    MapKind map = MAP_MAZE;
+    int rows = 256;
+    int cols = 0;
+    uint64_t seed = 1;
+    int cellPixels = 0;
+    if (argc > 3 && parseMap(argv[3], &map) != 0) {
+        return 1;
+    }
+    if (argc < 1 || (argc > 1 && parseInt(argv[1], 1, &rows) != 0) || (argc > 2 && parseInt(argv[2], 1, &cols) != 0)
+        || (argc > 4 && parseSeed(argv[4], &seed) != 0) || (argc > 5 && parseInt(argv[5], 0, &cellPixels) != 0)) {
+        fprintf(stderr, "Usage: main --render file.ppm|file.png [rows] [cols] [random|maze|cave|dungeon] [seed] [cell px]\n");
+        return 1;
+    }
+    if (cols == 0) {
+        cols = rows;
+    }
+    if (cellPixels == 0) {
+        cellPixels = defaultCellPixels(rows, cols);
+    }
+
+    Grid grid;
+    if (initGrid(&grid, rows, cols, LAYOUT_ROW_MAJOR) != 0) {
+        return 1;
+    }
+    SnapshotBuffer snapshots;
+    if (initSnapshots(&snapshots, rows, cols) != 0) {
+        freeGrid(&grid);
+        return 1;
+    }
+    Image image;
+    if (initImage(&image, rows, cols, cellPixels, IMAGE_SPACING) != 0) {
+        freeSnapshots(&snapshots);
+        freeGrid(&grid);
+        return 1;
+    }
+
+    int threads = defaultThreadCount();
+    Rng rng;
+    seedRng(&rng, seed);
+    generateMap(&grid, &rng, map, IMAGE_DENSITY, threads);
+    Cell *startCell = firstWalkable(&grid);
+    Cell *endCell = lastWalkable(&grid);
+    if (startCell != NULL && endCell != NULL) {
+        startCell->isStartCell = 1;
+        endCell->isEndCell = 1;
+        astar(&grid, startCell, endCell);
+    }
+    publishSnapshot(&snapshots, &grid);
+
+    drawImage(&image, acquireSnapshot(&snapshots), colors, threads);
+    int result = writeImage(&image, argv[0]);
+    if (result == 0) {
+        printf("Wrote %s: %s map %dx%d, %dx%d px\n", argv[0], mapName(map), rows, cols, image.width, image.height);
+    }
+
+    freeImage(&image);
+    freeSnapshots(&snapshots);
+    freeGrid(&grid);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <SDL2/SDL.h>
+#include "astar.h"
+#include "hud.h"
+
+#define GLYPH_WIDTH 5
+#define GLYPH_HEIGHT 7
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH 'Z'
+#define HUD_LINES 6
+#define HUD_MAX_KILOBYTES 9999999u
+
+// One byte per row, top row first, bit 4 is the leftmost pixel. Covers
+// space to 'Z'; lowercase is drawn as uppercase and anything else as space.
+static const unsigned char FONT[LAST_GLYPH - FIRST_GLYPH + 1][GLYPH_HEIGHT] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // space
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // !
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // "
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // #
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // $
+    {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}, // %
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // &
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // '
+    {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}, // (
+    {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}, // )
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // *
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // +
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ,
+    {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}, // -
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}, // .
+    {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}, // /
+    {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}, // 0
+    {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}, // 1
+    {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}, // 2
+    {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}, // 3
+    {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}, // 4
+    {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}, // 5
+    {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}, // 6
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}, // 7
+    {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}, // 8
+    {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}, // 9
+    {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}, // :
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ;
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // <
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // =
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // >
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ?
+    {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // @
+    {0x0E, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // A
+    {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}, // B
+    {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}, // C
+    {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}, // D
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}, // E
+    {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}, // F
+    {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}, // G
+    {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}, // H
+    {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}, // I
+    {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}, // J
+    {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}, // K
+    {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}, // L
+    {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}, // M
+    {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}, // N
+    {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // O
+    {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}, // P
+    {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}, // Q
+    {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}, // R
+    {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}, // S
+    {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}, // T
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}, // U
+    {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}, // V
+    {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}, // W
+    {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}, // X
+    {0x11, 0x11, 0x0A, 0x04, 0x04, 0x04, 0x04}, // Y
+    {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}, // Z
+};
+
+// Every lit font pixel of one line, filled in one call
+static SDL_Rect pixels[HUD_LINE_CHARS * GLYPH_WIDTH * GLYPH_HEIGHT];
+
+static const unsigned char* glyph(char c) {
+    if (c >= 'a' && c <= 'z') {
+        c = (char)(c - 'a' + 'A');
+    }
+    if (c < FIRST_GLYPH || c > LAST_GLYPH) {
+        c = ' ';
+    }
+    return FONT[c - FIRST_GLYPH];
+}
+
+static void drawText(SDL_Renderer *renderer, const char *text, int x, int y) {
+    int count = 0;
+    for (int i = 0; text[i] != '\0' && i < HUD_LINE_CHARS; i++) {
+        const unsigned char *rows = glyph(text[i]);
+        int left = x + i * (GLYPH_WIDTH + 1) * HUD_SCALE;
+        for (int row = 0; row < GLYPH_HEIGHT; row++) {
+            for (int col = 0; col < GLYPH_WIDTH; col++) {
+                if (rows[row] & (0x10 >> col)) {
+                    SDL_Rect *rect = &pixels[count++];
+                    rect->x = left + col * HUD_SCALE;
+                    rect->y = y + row * HUD_SCALE;
+                    rect->w = HUD_SCALE;
+                    rect->h = HUD_SCALE;
+                }
+            }
+        }
+    }
+    if (count > 0) {
+        SDL_RenderFillRects(renderer, pixels, count);
+    }
+}
+
+static const char* statusName(SearchStatus status) {
+    switch (status) {
+        case SEARCH_RUNNING:
+            return "running";
+        case SEARCH_FOUND:
+            return "found";
+        case SEARCH_FAILED:
+            return "no path";
+        default:
+            return "idle";
+    }
+}
+
+// Rounded up and capped at seven digits so every line fits HUD_LINE_CHARS
+static unsigned int hudKilobytes(size_t bytes) {
+    size_t kilobytes = bytes / 1024 + (bytes % 1024 != 0);
+    return kilobytes < HUD_MAX_KILOBYTES ? (unsigned int)kilobytes : HUD_MAX_KILOBYTES;
+}
+
+void initHud(Hud *hud, int visible) {
+    hud->visible = visible;
+    hud->frameMs = 0.0;
+    hud->renderMs = 0.0;
+    hud->lastPresent = 0;
+}
+
+// Takes performance counter readings from the start of a frame, the end of
+// its drawing and after its present
+void noteFrame(Hud *hud, Uint64 started, Uint64 drawn, Uint64 presented) {
+    double msPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+    hud->renderMs = (double)(drawn - started) * msPerTick;
+    if (hud->lastPresent != 0) {
+        hud->frameMs = (double)(presented - hud->lastPresent) * msPerTick;
+    }
+    hud->lastPresent = presented;
+}
+
+void drawHud(SDL_Renderer *renderer, const Hud *hud, const GridSnapshot *snapshot) {
+    const SearchStats *stats = &snapshot->stats;
+    double searchMs = (double)stats->ticks * 1000.0 / (double)SDL_GetPerformanceFrequency();
+    char lines[HUD_LINES][HUD_LINE_CHARS + 1];
+
+    snprintf(lines[0], sizeof(lines[0]), "frame %.1f ms  render %.1f ms", hud->frameMs, hud->renderMs);
+    snprintf(lines[1], sizeof(lines[1]), "search %.1f ms  %s", searchMs, statusName(stats->status));
+    snprintf(lines[2], sizeof(lines[2]), "expanded %zu", stats->expanded);
+    snprintf(lines[3], sizeof(lines[3]), "open peak %zu", stats->openPeak);
+    if (stats->status == SEARCH_FOUND) {
+        snprintf(lines[4], sizeof(lines[4]), "path %d cells  cost %d", stats->pathLength, stats->pathCost);
+    } else {
+        snprintf(lines[4], sizeof(lines[4]), "path -");
+    }
+    snprintf(lines[5], sizeof(lines[5]), "arena %u / %u kb", hudKilobytes(stats->arenaPeak), hudKilobytes(stats->arenaReserved));
+
+    int lineHeight = (GLYPH_HEIGHT + 3) * HUD_SCALE;
+    int longest = 0;
+    for (int i = 0; i < HUD_LINES; i++) {
+        int length = (int)SDL_strlen(lines[i]);
+        longest = length > longest ? length : longest;
+    }
+
+    // Darken the corner so the text reads over any cells
+    SDL_Rect panel = {
+        HUD_MARGIN / 2,
+        HUD_MARGIN / 2,
+        longest * (GLYPH_WIDTH + 1) * HUD_SCALE + HUD_MARGIN,
+        HUD_LINES * lineHeight + HUD_MARGIN - 3 * HUD_SCALE
+    };
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+    SDL_RenderFillRect(renderer, &panel);
+
+    SDL_SetRenderDrawColor(renderer, 235, 235, 235, 255);
+    for (int i = 0; i < HUD_LINES; i++) {
+        drawText(renderer, lines[i], HUD_MARGIN, HUD_MARGIN + i * lineHeight);
+    }
+}
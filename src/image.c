@@ -0,0 +1,237 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "image.h"
+#include "parallel.h"
+
+
+// Gaps only show while cells are wider than them, as in the window
+// Sizes are worked out in size_t; images whose sides do not fit an int or
+// whose pixels do not fit in memory are refused.
+int initImage(Image *image, int rows, int cols, int cellPixels, int spacing) {
+    image->pixels = NULL;
+    image->cellPixels = cellPixels;
+    image->gap = cellPixels > spacing ? spacing : 0;
+    if (rows <= 0 || cols <= 0 || cellPixels <= 0) {
+        fprintf(stderr, "Invalid image of %dx%d cells at %d px\n", rows, cols, cellPixels);
+        return -1;
+    }
+    size_t pitch = (size_t)cellPixels + (size_t)image->gap;
+    size_t width = (size_t)cols * pitch;
+    size_t height = (size_t)rows * pitch;
+    if (width > INT_MAX || height > INT_MAX || width > SIZE_MAX / 3 / height) {
+        fprintf(stderr, "Image of %dx%d cells at %d px is too large\n", rows, cols, cellPixels);
+        return -1;
+    }
+    image->width = (int)width;
+    image->height = (int)height;
+    image->pixels = (uint8_t *)malloc(width * height * 3);
+    if (image->pixels == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+void freeImage(Image *image) {
+    free(image->pixels);
+    image->pixels = NULL;
+}
+
+static inline void putPixel(uint8_t *pixel, const Color *color) {
+    pixel[0] = color->r;
+    pixel[1] = color->g;
+    pixel[2] = color->b;
+}
+
+typedef struct {
+    Image *image;
+    const GridSnapshot *snapshot;
+    const Color *colors;
+} ImageJob;
+
+// Draws the first pixel row of each cell row, then copies it down the
+// cell and fills the gap under it with background
+static void drawImageBand(void *context, int band) {
+    const ImageJob *job = (const ImageJob *)context;
+    Image *image = job->image;
+    const GridSnapshot *snapshot = job->snapshot;
+    const Color *background = &job->colors[2];
+    int pitch = image->cellPixels + image->gap;
+    size_t rowBytes = (size_t)image->width * 3;
+    int last = SDL_min((band + 1) * IMAGE_BAND_ROWS, snapshot->rows);
+
+    for (int row = band * IMAGE_BAND_ROWS; row < last; row++) {
+        uint8_t *first = &image->pixels[(size_t)row * pitch * rowBytes];
+        uint8_t *pixel = first;
+        const uint8_t *states = &snapshot->states[(size_t)row * snapshot->cols];
+        for (int col = 0; col < snapshot->cols; col++) {
+            const Color *color = &job->colors[STATE_COLORS[states[col]]];
+            for (int x = 0; x < image->cellPixels; x++, pixel += 3) {
+                putPixel(pixel, color);
+            }
+            for (int x = 0; x < image->gap; x++, pixel += 3) {
+                putPixel(pixel, background);
+            }
+        }
+        for (int y = 1; y < image->cellPixels; y++) {
+            memcpy(first + y * rowBytes, first, rowBytes);
+        }
+        for (int y = image->cellPixels; y < pitch; y++) {
+            pixel = first + y * rowBytes;
+            for (int x = 0; x < image->width; x++, pixel += 3) {
+                putPixel(pixel, background);
+            }
+        }
+    }
+}
+
+// The same colours drawGrid() uses, one band of cell rows per tile
+void drawImage(Image *image, const GridSnapshot *snapshot, const Color* colors, int threads) {
+    ImageJob job = {image, snapshot, colors};
+    runTiles((snapshot->rows + IMAGE_BAND_ROWS - 1) / IMAGE_BAND_ROWS, threads, drawImageBand, &job);
+}
+
+int writePpm(const Image *image, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open '%s' for writing\n", path);
+        return -1;
+    }
+    fprintf(file, "P6\n%d %d\n255\n", image->width, image->height);
+    size_t bytes = (size_t)image->width * image->height * 3;
+    int result = fwrite(image->pixels, 1, bytes, file) == bytes ? 0 : -1;
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+// PNG without a zlib dependency: the pixels go in deflate's stored
+// (uncompressed) blocks, one IDAT chunk per image row
+
+static uint32_t CRC_TABLE[256];
+
+static void buildCrcTable(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = crc & 1 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+        }
+        CRC_TABLE[i] = crc;
+    }
+}
+
+static uint32_t updateCrc(uint32_t crc, const uint8_t *bytes, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        crc = CRC_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static void putBigEndian(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)(value >> 24);
+    bytes[1] = (uint8_t)(value >> 16);
+    bytes[2] = (uint8_t)(value >> 8);
+    bytes[3] = (uint8_t)value;
+}
+
+static int writeChunk(FILE *file, const char *type, const uint8_t *data, size_t length) {
+    uint8_t header[8];
+    uint8_t footer[4];
+    putBigEndian(header, (uint32_t)length);
+    memcpy(header + 4, type, 4);
+    uint32_t crc = updateCrc(0xFFFFFFFFu, header + 4, 4);
+    crc = updateCrc(crc, data, length) ^ 0xFFFFFFFFu;
+    putBigEndian(footer, crc);
+    return fwrite(header, 1, 8, file) == 8 && fwrite(data, 1, length, file) == length && fwrite(footer, 1, 4, file) == 4 ? 0 : -1;
+}
+
+#define STORED_BLOCK_MAX 65535
+
+int writePng(const Image *image, const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open '%s' for writing\n", path);
+        return -1;
+    }
+    buildCrcTable();
+
+    // A row is its filter byte and pixels, split into stored blocks, plus
+    // the zlib header before the first row and the checksum after the last
+    size_t rowBytes = (size_t)image->width * 3 + 1;
+    size_t blocks = (rowBytes + STORED_BLOCK_MAX - 1) / STORED_BLOCK_MAX;
+    uint8_t *chunk = (uint8_t *)malloc(2 + blocks * 5 + rowBytes + 4);
+    uint8_t *row = (uint8_t *)malloc(rowBytes);
+    if (chunk == NULL || row == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free(chunk);
+        free(row);
+        fclose(file);
+        return -1;
+    }
+
+    static const uint8_t SIGNATURE[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    uint8_t header[13];
+    putBigEndian(header, (uint32_t)image->width);
+    putBigEndian(header + 4, (uint32_t)image->height);
+    header[8] = 8;      // bits per channel
+    header[9] = 2;      // RGB
+    header[10] = 0;
+    header[11] = 0;
+    header[12] = 0;
+    int result = fwrite(SIGNATURE, 1, 8, file) == 8 ? 0 : -1;
+    result |= writeChunk(file, "IHDR", header, sizeof(header));
+
+    uint32_t adlerLow = 1;
+    uint32_t adlerHigh = 0;
+    for (int y = 0; y < image->height && result == 0; y++) {
+        row[0] = 0;     // no filter
+        memcpy(row + 1, &image->pixels[(size_t)y * (rowBytes - 1)], rowBytes - 1);
+        for (size_t i = 0; i < rowBytes; i++) {
+            adlerLow = (adlerLow + row[i]) % 65521;
+            adlerHigh = (adlerHigh + adlerLow) % 65521;
+        }
+
+        size_t length = 0;
+        if (y == 0) {
+            chunk[length++] = 0x78;
+            chunk[length++] = 0x01;
+        }
+        for (size_t offset = 0; offset < rowBytes; offset += STORED_BLOCK_MAX) {
+            size_t size = SDL_min(rowBytes - offset, (size_t)STORED_BLOCK_MAX);
+            int final = y == image->height - 1 && offset + size == rowBytes;
+            chunk[length++] = (uint8_t)final;
+            chunk[length++] = (uint8_t)size;
+            chunk[length++] = (uint8_t)(size >> 8);
+            chunk[length++] = (uint8_t)~size;
+            chunk[length++] = (uint8_t)(~size >> 8);
+            memcpy(chunk + length, row + offset, size);
+            length += size;
+        }
+        if (y == image->height - 1) {
+            putBigEndian(chunk + length, adlerHigh << 16 | adlerLow);
+            length += 4;
+        }
+        result |= writeChunk(file, "IDAT", chunk, length);
+    }
+    result |= writeChunk(file, "IEND", NULL, 0);
+
+    free(chunk);
+    free(row);
+    if (fclose(file) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+// PNG for paths ending in .png, PPM otherwise
+int writeImage(const Image *image, const char *path) {
+    size_t length = strlen(path);
+    if (length >= 4 && SDL_strcasecmp(path + length - 4, ".png") == 0) {
+        return writePng(image, path);
+    }
+    return writePpm(image, path);
+}
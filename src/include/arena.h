@@ -0,0 +1,37 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_ALIGN 16
+#define DEFAULT_ARENA_SIZE ((size_t)1 << 20)
+
+typedef struct ArenaBlock {
+    struct ArenaBlock *prev;
+    size_t capacity;
+    size_t used;
+} ArenaBlock;
+
+// Bump allocator for per-query scratch memory. Everything handed out is
+// released at once by resetArena(). Running out of room chains another
+// block (counted in blockMallocs); the next reset folds them into one block
+// big enough for the high-water mark, so a steady workload stops mallocing.
+typedef struct {
+    ArenaBlock *block;
+    void *last;             // most recent allocation, the only one that can grow in place
+    size_t used;            // bytes handed out since the last reset
+    size_t highWater;       // largest `used` ever seen
+    size_t blockMallocs;    // blocks that had to be allocated mid-query
+} Arena;
+
+int initArena(Arena *arena, size_t capacity);
+void freeArena(Arena *arena);
+void* arenaAlloc(Arena *arena, size_t size);
+void* arenaGrow(Arena *arena, void *memory, size_t oldSize, size_t newSize);
+void resetArena(Arena *arena);
+size_t arenaCapacity(const Arena *arena);
+
+Arena* searchArena(void);
+int reserveSearchArena(size_t capacity);
+
+#endif // ARENA_H
@@ -4,28 +4,87 @@
 #include <SDL2/SDL.h>
 #include <stddef.h>
 #include <stdlib.h>
-#include "color.h"
 #include "cell.h"
-#include "cursor.h"
+#include "grid.h"
+#include "ring.h"
 
 
+// An expanded cell has at most this many neighbours
+#define MAX_NEIGHBOURS 8
+
+// Binary min-heap on (fCost, hCost). A cell whose cost drops while open is
+// pushed again instead of being moved; the stale entry comes out after the
+// cell has closed and is skipped.
+typedef struct {
+    int fCost;
+    int hCost;
+    uint32_t cell;      // index into Grid.cells
+} OpenEntry;
+
 typedef struct {
-    Cell **cells;
+    OpenEntry *entries;
     size_t size;
     size_t capacity;
-} CellList;
-
-void initCellList(CellList *list, size_t initial_capacity);
-void push(CellList *list, Cell* cell);
-Cell* pop(CellList *list);
-Cell* removeCell(CellList *list, Cell *cell);
-void freeCellList(CellList *list);
-Cell* findLowestFCost(CellList *list);
-int contains(CellList *list, Cell *cell);
-int heuristic(Cell* a, Cell* b);
-void calculateCosts(Cell* currnet, Cell* start, Cell* end);
-void updateNeighbours(Cell** grid, CellList* neighboursList, Cell* cell, const  int* width, const int* height);
-void astar(Cursor* cursor, SDL_Renderer *renderer, const Color* colors, Cell **grid, Cell *startCell, Cell *endCell, const int* width, const int* height, const int* rows, const int* cols, const int* spacing);
+} OpenList;
+
+typedef enum {
+    SEARCH_IDLE,
+    SEARCH_RUNNING,
+    SEARCH_FOUND,
+    SEARCH_FAILED
+} SearchStatus;
+
+// What a traced search reports as it goes
+typedef enum {
+    TRACE_OPEN,
+    TRACE_CLOSE,
+    TRACE_PATH,
+    TRACE_EVENT_TYPES
+} TraceEventType;
+
+typedef struct {
+    uint32_t cell;      // row * cols + col
+    uint32_t type;      // TraceEventType
+} TraceEvent;
+
+// What a query has cost so far, for the HUD
+typedef struct {
+    SearchStatus status;
+    Uint64 ticks;           // performance counter ticks spent searching
+    size_t expanded;
+    size_t openPeak;        // most entries the open heap held
+    size_t arenaPeak;       // most search arena bytes in use at once
+    size_t arenaReserved;   // bytes the search arena holds
+    int pathLength;         // cells on the path once found
+    int pathCost;           // g cost of the end cell once found
+} SearchStats;
+
+// A query that can run a slice at a time. Its open list lives in the
+// thread's search arena until the query ends, so a thread runs one at a time.
+typedef struct {
+    Grid *grid;
+    Cell *startCell;
+    Cell *endCell;
+    int endRow;
+    int endCol;
+    OpenList open;
+    SearchStatus status;
+    Ring *trace;            // TraceEvents go here when not NULL
+    size_t traceDropped;    // events lost to a full trace ring
+    SearchStats stats;
+} Search;
+
+void initOpenList(OpenList *list, size_t initial_capacity);
+void pushOpen(OpenList *list, uint32_t cell, int fCost, int hCost);
+int popOpen(OpenList *list, uint32_t *cell);
+void freeOpenList(OpenList *list);
+int heuristic(int row, int col, int toRow, int toCol);
+void initSearch(Search *search);
+void startSearch(Search *search, Grid *grid, Cell *startCell, Cell *endCell);
+SearchStatus stepSearch(Search *search, size_t expansions);
+SearchStatus runSearch(Search *search, Uint64 deadline);
+void stopSearch(Search *search);
+void astar(Grid *grid, Cell *startCell, Cell *endCell);
 
 
 #endif // ASTAR_H
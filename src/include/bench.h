@@ -0,0 +1,6 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+int runBenchmarks(int argc, char *argv[]);
+
+#endif // BENCH_H
@@ -0,0 +1,57 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <math.h>
+
+// Closest and farthest zoom, in pixels per cell
+#define MAX_CELL_PIXELS 64.0
+#define MIN_FIT_FRACTION 0.5    // can zoom out to half the size that fits
+
+// Which part of the grid the window shows. The grid position under the
+// window's top-left corner is (x, y) in cells, and one cell is `scale`
+// pixels wide; below 1 several cells share a pixel.
+typedef struct {
+    double x;
+    double y;
+    double scale;
+    double minScale;
+    double maxScale;
+} Camera;
+
+// Half-open range of cells that is at least partly on screen
+typedef struct {
+    int top;
+    int left;
+    int bottom;
+    int right;
+} CellWindow;
+
+void fitCamera(Camera *camera, int width, int height, int rows, int cols);
+void zoomCamera(Camera *camera, double factor, int pixelX, int pixelY);
+void panCamera(Camera *camera, int dx, int dy);
+CellWindow visibleWindow(const Camera *camera, int width, int height, int rows, int cols);
+int sameView(const Camera *a, const Camera *b);
+
+// Screen edge of a cell column/row; neighbouring cells share their edges
+static inline int cellScreenX(const Camera *camera, int col) {
+    return (int)floor((col - camera->x) * camera->scale);
+}
+
+static inline int cellScreenY(const Camera *camera, int row) {
+    return (int)floor((row - camera->y) * camera->scale);
+}
+
+static inline int screenToCol(const Camera *camera, int pixelX) {
+    return (int)floor(camera->x + pixelX / camera->scale);
+}
+
+static inline int screenToRow(const Camera *camera, int pixelY) {
+    return (int)floor(camera->y + pixelY / camera->scale);
+}
+
+// Cells per drawn cell when zoomed out past one cell per pixel
+static inline int cellStep(const Camera *camera) {
+    return camera->scale < 1 ? (int)ceil(1 / camera->scale) : 1;
+}
+
+#endif // CAMERA_H
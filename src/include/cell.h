@@ -3,20 +3,26 @@
 
 #include "color.h"
 
+#include <stdint.h>
+
+// Parent of a cell that was not reached from another one
+#define NO_PARENT UINT32_MAX
+
+// Kept to 16 bytes because there is one per grid cell: flags are single bits
+// and share a word with the id of the search that last wrote the search
+// fields. A cell's position follows from where it is in the grid's array,
+// the parent is stored as that array index and f is just g + h.
+// Walkability is not stored here, it lives in the grid's bitmap.
 typedef struct Cell{
-    int walkable;
     int gCost;
     int hCost;
-    int fCost; 
-    int x;
-    int y;
-    int isStartCell;
-    int isEndCell;
-    int isPath;
-    int isClosed;
-    int isOpen;
-    int visited;
-    struct Cell *parent;
+    unsigned int search : 24;
+    unsigned int isStartCell : 1;
+    unsigned int isEndCell : 1;
+    unsigned int isPath : 1;
+    unsigned int isClosed : 1;
+    unsigned int isOpen : 1;
+    uint32_t parent;    // index into Grid.cells, NO_PARENT for none
 } Cell;
 
-#endif // CELL_H
\ No newline at end of file
+#endif // CELL_H
@@ -1,7 +1,7 @@
 #ifndef COLOR_H
 #define COLOR_H
 
-#include <stdint.h>
+#include <SDL2/SDL_stdinc.h>
 
 typedef struct {
     Uint8 r; // Red 
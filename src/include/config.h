@@ -0,0 +1,35 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "grid.h"
+
+typedef struct {
+    int width;
+    int height;
+    int rows;
+    int cols;
+    int spacing;
+    GridLayout layout;
+    size_t arenaSize;   // bytes reserved up front for each search arena
+    uint64_t seed;      // map generators draw from an Rng seeded with this
+    double density;     // share of blocked cells in random maps
+    int threads;        // map generator threads, 0 for one per CPU
+    int texture;        // draw the grid as one texel per cell, scaled to the window
+    int searchBudget;   // milliseconds of search between published snapshots
+    int trace;          // start with search events flashed on screen as they happen
+    int heat;           // start counting search work per cell, shown as a heatmap
+    int hud;            // start with frame and search statistics shown
+} Config;
+
+void defaultConfig(Config *config);
+int parseInt(const char *value, int min, int *out);
+int parseSeed(const char *value, uint64_t *out);
+int parseFraction(const char *value, double *out);
+int setOption(Config *config, const char *key, const char *value);
+int loadConfigFile(Config *config, const char *path);
+int parseArgs(Config *config, int argc, char *argv[]);
+void printUsage(const char *program);
+
+#endif // CONFIG_H
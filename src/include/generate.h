@@ -0,0 +1,42 @@
+#ifndef GENERATE_H
+#define GENERATE_H
+
+#include <stdint.h>
+#include "grid.h"
+#include "rng.h"
+
+typedef enum {
+    MAP_RANDOM,
+    MAP_MAZE,
+    MAP_CAVE,
+    MAP_DUNGEON
+} MapKind;
+
+// Receives each finished row of a streamed maze as walkability bits,
+// returns non-zero to stop generation
+typedef int (*MazeRowSink)(void *context, int row, const uint64_t *bits, int cols);
+
+// Half-open block of cells a maze is carved in; top and left are even
+typedef struct {
+    int top;
+    int left;
+    int bottom;
+    int right;
+} MazeRegion;
+
+unsigned int densityThreshold(double density);
+uint64_t randomMask(Rng *rng, unsigned int threshold);
+void randomizeGrid(Grid *grid, Rng *rng, double density, int threads);
+void generateMaze(Grid *grid, Rng *rng, const MazeRegion *region, int row, int col);
+void initializeMaze(Grid *grid, Rng *rng, int threads);
+void generateCaves(Grid *grid, Rng *rng, int threads);
+void generateDungeon(Grid *grid, Rng *rng);
+int generateEllerMaze(Rng *rng, int rows, int cols, MazeRowSink sink, void *context);
+int gridRowSink(void *context, int row, const uint64_t *bits, int cols);
+void initializeEllerMaze(Grid *grid, Rng *rng);
+int writeMazeFile(const char *path, int rows, int cols, uint64_t seed);
+void generateMap(Grid *grid, Rng *rng, MapKind map, double density, int threads);
+const char* mapName(MapKind map);
+int parseMap(const char *name, MapKind *map);
+
+#endif // GENERATE_H
@@ -0,0 +1,195 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "cell.h"
+
+// Tiled layouts store the grid as 8x8 blocks so that every neighbour of a
+// cell is usually in the same (or an adjacent) block of memory.
+#define TILE_SHIFT 3
+#define TILE_SIZE (1 << TILE_SHIFT)
+#define TILE_MASK (TILE_SIZE - 1)
+
+// Cell.search is 24 bits wide
+#define MAX_SEARCH_ID ((1u << 24) - 1)
+
+typedef enum {
+    LAYOUT_ROW_MAJOR,   // classic row after row
+    LAYOUT_TILED,       // 8x8 tiles, row-major inside each tile
+    LAYOUT_MORTON       // 8x8 tiles, Z-order inside each tile
+} GridLayout;
+
+// Cells whose display may have changed since the last publish. Cells are
+// listed once each; past `capacity` of them the set just becomes `all`.
+typedef struct {
+    uint32_t *cells;    // row * cols + col
+    size_t count;
+    size_t capacity;
+    uint64_t *marked;   // one bit per cell, same layout as the walkable bitmap
+    int all;
+} DirtySet;
+
+typedef struct {
+    Cell *cells;
+    int rows;
+    int cols;
+    int tilesPerRow;
+    size_t cellCount;   // allocated cells, including tile padding
+    GridLayout layout;
+    unsigned int search; // cells whose search id differs have no search state
+    uint64_t *walkable;  // one bit per cell, row-major, bits past cols stay 0
+    size_t wordsPerRow;
+    DirtySet dirty;
+    uint16_t *heat;      // expansions and relaxations per cell, row-major; NULL unless profiling
+} Grid;
+
+int initGrid(Grid *grid, int rows, int cols, GridLayout layout);
+void freeGrid(Grid *grid);
+void beginSearch(Grid *grid);
+void setAllWalkable(Grid *grid, int walkable);
+void markAllDirty(Grid *grid);
+void clearDirty(Grid *grid);
+int enableHeat(Grid *grid);
+void disableHeat(Grid *grid);
+const char* layoutName(GridLayout layout);
+Cell* firstWalkable(const Grid *grid);
+Cell* lastWalkable(const Grid *grid);
+
+
+// Spreads the low three bits of v to the even bit positions (0b abc -> 0b a0b0c)
+static const unsigned char MORTON_SPREAD[TILE_SIZE] = {0, 1, 4, 5, 16, 17, 20, 21};
+
+static inline size_t cellIndex(const Grid *grid, int row, int col) {
+    size_t tile;
+    switch (grid->layout) {
+        case LAYOUT_TILED:
+            tile = (size_t)(row >> TILE_SHIFT) * grid->tilesPerRow + (col >> TILE_SHIFT);
+            return (tile << (2 * TILE_SHIFT)) + ((row & TILE_MASK) << TILE_SHIFT) + (col & TILE_MASK);
+        case LAYOUT_MORTON:
+            tile = (size_t)(row >> TILE_SHIFT) * grid->tilesPerRow + (col >> TILE_SHIFT);
+            return (tile << (2 * TILE_SHIFT)) + (MORTON_SPREAD[row & TILE_MASK] << 1 | MORTON_SPREAD[col & TILE_MASK]);
+        default:
+            return (size_t)row * grid->cols + col;
+    }
+}
+
+static inline Cell* getCell(const Grid *grid, int row, int col) {
+    return &grid->cells[cellIndex(grid, row, col)];
+}
+
+static inline size_t indexOfCell(const Grid *grid, const Cell *cell) {
+    return (size_t)(cell - grid->cells);
+}
+
+// Inverse of cellIndex()
+static inline void cellPosition(const Grid *grid, size_t index, int *row, int *col) {
+    size_t tile;
+    unsigned int inTile;
+    switch (grid->layout) {
+        case LAYOUT_TILED:
+            tile = index >> (2 * TILE_SHIFT);
+            inTile = (unsigned int)(index & (TILE_SIZE * TILE_SIZE - 1));
+            *row = (int)(tile / grid->tilesPerRow << TILE_SHIFT) + (int)(inTile >> TILE_SHIFT);
+            *col = (int)(tile % grid->tilesPerRow << TILE_SHIFT) + (int)(inTile & TILE_MASK);
+            break;
+        case LAYOUT_MORTON:
+            tile = index >> (2 * TILE_SHIFT);
+            inTile = (unsigned int)(index & (TILE_SIZE * TILE_SIZE - 1));
+            // Odd bits of the Z-order index are the row, even bits the column
+            *row = (int)(tile / grid->tilesPerRow << TILE_SHIFT) + (int)((inTile >> 3 & 4) | (inTile >> 2 & 2) | (inTile >> 1 & 1));
+            *col = (int)(tile % grid->tilesPerRow << TILE_SHIFT) + (int)((inTile >> 2 & 4) | (inTile >> 1 & 2) | (inTile & 1));
+            break;
+        default:
+            *row = (int)(index / grid->cols);
+            *col = (int)(index % grid->cols);
+            break;
+    }
+}
+
+static inline uint64_t* walkableRow(const Grid *grid, int row) {
+    return &grid->walkable[(size_t)row * grid->wordsPerRow];
+}
+
+// Bits of a row's last word that belong to real columns
+static inline uint64_t lastWordMask(const Grid *grid) {
+    return (grid->cols & 63) ? ((uint64_t)1 << (grid->cols & 63)) - 1 : ~(uint64_t)0;
+}
+
+static inline int isWalkable(const Grid *grid, int row, int col) {
+    return (int)(walkableRow(grid, row)[col >> 6] >> (col & 63)) & 1;
+}
+
+static inline void setWalkable(Grid *grid, int row, int col, int walkable) {
+    uint64_t bit = (uint64_t)1 << (col & 63);
+    uint64_t *word = &walkableRow(grid, row)[col >> 6];
+    *word = walkable ? (*word | bit) : (*word & ~bit);
+}
+
+// Longest dirty list worth keeping; beyond it redrawing everything is as
+// cheap. Grids too big for 32-bit cell indices are always fully dirty.
+static inline size_t dirtyLimit(int rows, int cols) {
+    size_t cells = (size_t)rows * cols;
+    if (cells > UINT32_MAX) {
+        return 0;
+    }
+    size_t limit = cells / 16 + 64;
+    return limit < ((size_t)1 << 20) ? limit : ((size_t)1 << 20);
+}
+
+static inline void markDirty(Grid *grid, int row, int col) {
+    DirtySet *dirty = &grid->dirty;
+    if (dirty->all) {
+        return;
+    }
+    uint64_t bit = (uint64_t)1 << (col & 63);
+    uint64_t *word = &dirty->marked[(size_t)row * grid->wordsPerRow + (col >> 6)];
+    if (*word & bit) {
+        return;
+    }
+    if (dirty->count == dirty->capacity) {
+        dirty->all = 1;
+        return;
+    }
+    *word |= bit;
+    dirty->cells[dirty->count++] = (uint32_t)row * grid->cols + col;
+}
+
+static inline void markCellDirty(Grid *grid, const Cell *cell) {
+    int row, col;
+    cellPosition(grid, indexOfCell(grid, cell), &row, &col);
+    markDirty(grid, row, col);
+}
+
+// Counts search work on a cell while profiling, saturating. The cell is
+// dirtied so the new count gets published.
+static inline void countHeat(Grid *grid, int row, int col) {
+    if (grid->heat != NULL) {
+        uint16_t *count = &grid->heat[(size_t)row * grid->cols + col];
+        if (*count < UINT16_MAX) {
+            (*count)++;
+        }
+        markDirty(grid, row, col);
+    }
+}
+
+// Search fields of a cell only count if it was touched by the current search
+static inline int inSearch(const Grid *grid, const Cell *cell) {
+    return cell->search == grid->search;
+}
+
+// Lazily resets a cell's search fields the first time a search reaches it
+static inline Cell* touchCell(const Grid *grid, Cell *cell) {
+    if (cell->search != grid->search) {
+        cell->gCost = 0;
+        cell->hCost = 0;
+        cell->isPath = 0;
+        cell->isOpen = 0;
+        cell->isClosed = 0;
+        cell->parent = NO_PARENT;
+        cell->search = grid->search;
+    }
+    return cell;
+}
+
+#endif // GRID_H
@@ -0,0 +1,8 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "color.h"
+
+int runHeadless(int argc, char *argv[], const Color* colors);
+
+#endif // HEADLESS_H
@@ -0,0 +1,26 @@
+#ifndef HUD_H
+#define HUD_H
+
+#include <SDL2/SDL.h>
+#include "snapshot.h"
+
+// Glyphs are 5x7 pixels drawn HUD_SCALE screen pixels per font pixel
+#define HUD_SCALE 2
+#define HUD_MARGIN 8
+// Longest line drawn, in characters
+#define HUD_LINE_CHARS 40
+
+// Overlay of frame timings and the last search's statistics, drawn with a
+// built-in bitmap font over the top-left corner of the window.
+typedef struct {
+    int visible;
+    double frameMs;     // between the last two presents
+    double renderMs;    // spent drawing the last frame, not counting vsync
+    Uint64 lastPresent; // performance counter at the last present, 0 for none
+} Hud;
+
+void initHud(Hud *hud, int visible);
+void noteFrame(Hud *hud, Uint64 started, Uint64 drawn, Uint64 presented);
+void drawHud(SDL_Renderer *renderer, const Hud *hud, const GridSnapshot *snapshot);
+
+#endif // HUD_H
@@ -0,0 +1,36 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include <stdint.h>
+#include "color.h"
+#include "snapshot.h"
+
+// Cell rows each thread draws at a time
+#define IMAGE_BAND_ROWS 64
+// Longest side an image gets when the cell size is not given
+#define IMAGE_TARGET_PIXELS 2048
+#define IMAGE_MAX_CELL_PIXELS 16
+#define IMAGE_SPACING 1
+
+// An RGB frame in memory, drawn without SDL's video subsystem
+typedef struct {
+    uint8_t *pixels;    // 3 bytes per pixel, row after row
+    int width;
+    int height;
+    int cellPixels;     // each cell is a square this wide
+    int gap;            // background pixels after each cell
+} Image;
+
+static inline int defaultCellPixels(int rows, int cols) {
+    int pixels = IMAGE_TARGET_PIXELS / (rows > cols ? rows : cols);
+    return pixels < 1 ? 1 : (pixels > IMAGE_MAX_CELL_PIXELS ? IMAGE_MAX_CELL_PIXELS : pixels);
+}
+
+int initImage(Image *image, int rows, int cols, int cellPixels, int spacing);
+void freeImage(Image *image);
+void drawImage(Image *image, const GridSnapshot *snapshot, const Color* colors, int threads);
+int writePpm(const Image *image, const char *path);
+int writePng(const Image *image, const char *path);
+int writeImage(const Image *image, const char *path);
+
+#endif // IMAGE_H
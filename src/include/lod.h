@@ -0,0 +1,38 @@
+#ifndef LOD_H
+#define LOD_H
+
+#include <stdint.h>
+#include "snapshot.h"
+
+#define MAX_LOD_LEVELS 32
+
+// Coarser copies of a snapshot for zoomed-out drawing. Level n has one
+// state per 2^n x 2^n block of cells: the highest CellState in the block,
+// so walls, the search and the path stay visible however far out the view
+// is. Level 0 is the snapshot itself and is not stored.
+typedef struct {
+    uint8_t *states[MAX_LOD_LEVELS];
+    int rows[MAX_LOD_LEVELS];
+    int cols[MAX_LOD_LEVELS];
+    int levels;
+    unsigned int epoch; // snapshot the levels were built from, 0 for none
+} LodPyramid;
+
+int initLod(LodPyramid *lod, int rows, int cols);
+void freeLod(LodPyramid *lod);
+void updateLod(LodPyramid *lod, const GridSnapshot *snapshot);
+
+static inline uint8_t lodState(const LodPyramid *lod, int level, int row, int col) {
+    return lod->states[level][(size_t)row * lod->cols[level] + col];
+}
+
+// Finest level whose blocks are at least a pixel at this many pixels per cell
+static inline int lodLevel(const LodPyramid *lod, double scale) {
+    int level = 0;
+    while (level + 1 < lod->levels && (double)(1 << level) * scale < 1) {
+        level++;
+    }
+    return level;
+}
+
+#endif // LOD_H
@@ -0,0 +1,12 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#define MAX_THREADS 64
+
+// Work for one tile; must only touch memory that belongs to that tile
+typedef void (*TileJob)(void *context, int tile);
+
+int defaultThreadCount(void);
+void runTiles(int tileCount, int threads, TileJob job, void *context);
+
+#endif // PARALLEL_H
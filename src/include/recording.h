@@ -0,0 +1,35 @@
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "color.h"
+#include "snapshot.h"
+
+#define FRAMES_MAGIC "PFRM"
+#define FRAMES_VERSION 1
+// Cells one run can carry
+#define FRAMES_MAX_RUN 65535
+
+// Streams snapshots to disk as runs of cells that changed since the last
+// frame written. Only the last frame is kept, so memory stays at one byte
+// per cell however many frames there are.
+typedef struct {
+    FILE *file;
+    uint8_t *previous;  // states of the last frame written
+    uint32_t *sorted;   // scratch for the snapshot's change list
+    size_t sortedCapacity;
+    int rows;
+    int cols;
+    unsigned int epoch; // snapshot the last frame came from, 0 for none
+    size_t frames;
+    size_t bytes;
+} FrameWriter;
+
+int openFrameWriter(FrameWriter *writer, const char *path, int rows, int cols, uint32_t expansionsPerFrame, const Color* colors);
+int writeFrame(FrameWriter *writer, const GridSnapshot *snapshot);
+int closeFrameWriter(FrameWriter *writer);
+int runRecording(int argc, char *argv[], const Color* colors);
+int runPlayback(int argc, char *argv[]);
+
+#endif // RECORDING_H
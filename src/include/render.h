@@ -2,19 +2,51 @@
 #define RENDER_H
 
 #include <SDL2/SDL.h>
+#include "astar.h"
 #include "cell.h"
+#include "camera.h"
 #include "color.h"
 #include "cursor.h"
+#include "grid.h"
+#include "hud.h"
+#include "lod.h"
+#include "snapshot.h"
 
+// The grid as a streaming texture with one texel per cell, which the GPU
+// scales to the window. Shadow copies of the texels and of the states they
+// show let an update write only the cells that changed since the last one.
+typedef struct {
+    SDL_Texture *texture;
+    Uint32 *pixels;
+    uint8_t *states;    // state each texel was last written for
+    int rows;
+    int cols;
+    unsigned int epoch; // snapshot the texels show, 0 for none
+} GridTexture;
+
+// Persistent render target holding the drawn grid. A frame redraws only the
+// cells a snapshot lists as changed, copies the target to the screen and
+// draws the cursor over it.
+typedef struct {
+    SDL_Texture *target;
+    unsigned int epoch; // snapshot the target shows, 0 for none
+    Camera camera;      // view the target was drawn with
+} GridCanvas;
 
 SDL_Renderer* init(SDL_Renderer* renderer, const Color* colors);
-void updateGrid(Cursor* cursor, SDL_Renderer *renderer, Cell **grid, const Color* colors, Cell **newGrid, const int* rows, const int* cols, const int* spacing, const int* width, const int* height, Cell *startCell, Cell *endCell);
-void drawGrid(SDL_Renderer *renderer, Cell **grid, const Color* colors, const int* width, const int* height, const int* rows, const int* cols, const int* spacing);
-void drawPath(SDL_Renderer* renderer, Cell **grid, const Color* pathColor, const int* width, const int* height, const int* rows, const int* cols, const int* spacing);
-void drawCursor(SDL_Renderer* renderer, Cursor* cursor, const int* width, const int* height, const int* rows, const int* cols, const int* spacing) ;
-void render(SDL_Renderer *renderer, Cell **grid, Cursor* cursor, const Color* colors, const int* width, const int* height, const int* rows, const int* cols, const int* spacing);
-void randomizeGrid(Cell **grid, const int* rows, const int* cols);
-void resetGrid(Cell **grid, const int* rows, const int* cols);
+void drawGrid(SDL_Renderer *renderer, const GridSnapshot *snapshot, const LodPyramid *lod, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing);
+void drawCursor(SDL_Renderer* renderer, Cursor* cursor, const Camera *camera, const int* rows, const int* cols, const int* spacing);
+void drawCells(SDL_Renderer *renderer, const GridSnapshot *snapshot, const LodPyramid *lod, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing);
+void drawHeat(SDL_Renderer *renderer, const GridSnapshot *snapshot, const Camera *camera, const int* width, const int* height, const int* spacing);
+void drawTrace(SDL_Renderer *renderer, const TraceEvent *events, size_t count, const Camera *camera, int rows, int cols, const int* width, const int* height, const int* spacing);
+void render(SDL_Renderer *renderer, const GridSnapshot *snapshot, LodPyramid *lod, const Camera *camera, GridCanvas *canvas, GridTexture *gridTexture, const TraceEvent *trace, size_t traceCount, Hud *hud, Cursor* cursor, const Color* colors, const int* width, const int* height, const int* spacing);
+int initGridTexture(GridTexture *gridTexture, SDL_Renderer *renderer, int rows, int cols);
+void freeGridTexture(GridTexture *gridTexture);
+int initGridCanvas(GridCanvas *canvas, SDL_Renderer *renderer, int width, int height);
+void freeGridCanvas(GridCanvas *canvas);
+void updateGridTexture(GridTexture *gridTexture, const GridSnapshot *snapshot, const Color* colors);
+void drawGridTexture(SDL_Renderer *renderer, GridTexture *gridTexture, const GridSnapshot *snapshot, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing);
+void resetGrid(Grid *grid);
 
 
 
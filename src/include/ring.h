@@ -0,0 +1,24 @@
+#ifndef RING_H
+#define RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <SDL2/SDL_atomic.h>
+
+// Fixed-size items passed from one thread to one other. Each side only
+// writes its own counter, so pushing and popping never wait; a full ring
+// refuses the push instead.
+typedef struct {
+    unsigned char *items;
+    size_t itemSize;
+    uint32_t mask;      // capacity - 1, the capacity is a power of two
+    SDL_atomic_t head;  // items popped so far, written by the reader
+    SDL_atomic_t tail;  // items pushed so far, written by the writer
+} Ring;
+
+int initRing(Ring *ring, uint32_t capacity, size_t itemSize);
+void freeRing(Ring *ring);
+int pushRing(Ring *ring, const void *item);
+int popRing(Ring *ring, void *item);
+
+#endif // RING_H
@@ -0,0 +1,38 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// xoshiro256** with explicit state, so generators are reproducible from a
+// seed and can run in parallel with one state each
+typedef struct {
+    uint64_t s[4];
+} Rng;
+
+void seedRng(Rng *rng, uint64_t seed);
+void seedRngStream(Rng *rng, uint64_t seed, uint64_t stream);
+
+static inline uint64_t rotateLeft(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t nextRandom(Rng *rng) {
+    uint64_t *s = rng->s;
+    uint64_t result = rotateLeft(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotateLeft(s[3], 45);
+    return result;
+}
+
+// Uniform in [0, bound) using the high bits of a 32x32 multiply
+static inline uint32_t randomBelow(Rng *rng, uint32_t bound) {
+    return (uint32_t)(((nextRandom(rng) >> 32) * bound) >> 32);
+}
+
+#endif // RNG_H
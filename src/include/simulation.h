@@ -0,0 +1,72 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <SDL2/SDL.h>
+#include "astar.h"
+#include "config.h"
+#include "grid.h"
+#include "ring.h"
+#include "rng.h"
+#include "snapshot.h"
+
+#define COMMAND_CAPACITY 1024
+// Search events buffered between frames; more than this are dropped
+#define TRACE_CAPACITY (1 << 16)
+
+typedef enum {
+    COMMAND_STROKE,     // line of cells to (toRow, toCol); value 1 clears them, 0 makes walls
+    COMMAND_SET_START,
+    COMMAND_SET_END,
+    COMMAND_PAUSE,      // toggles
+    COMMAND_FINISH,     // runs the current (or a fresh) search to the end
+    COMMAND_TRACE,      // toggles search events
+    COMMAND_HEAT,       // toggles counting search work, clearing the counts
+    COMMAND_MAZE,
+    COMMAND_ELLER,
+    COMMAND_RANDOM,
+    COMMAND_CAVES,
+    COMMAND_DUNGEON,
+    COMMAND_CLEAR
+} CommandType;
+
+typedef struct {
+    CommandType type;
+    int row;
+    int col;
+    int value;
+    int toRow;
+    int toCol;
+} Command;
+
+// Owns the grid and the search on a thread of its own. Input reaches it
+// through a command ring and what it shows leaves through the snapshot
+// triple buffer, so a long search never holds up drawing or input.
+typedef struct {
+    Grid *grid;
+    SnapshotBuffer *snapshots;
+    const Config *config;
+    int threads;
+    Rng rng;
+    Search search;
+    Cell *startCell;
+    Cell *endCell;
+    int paused;
+    int edited;
+    int searchStale;        // the grid changed since the last search started
+    Uint64 searchBudget;    // performance counter ticks per published slice
+    Ring commands;
+    Ring trace;             // TraceEvents from the search while tracing
+    SDL_sem *wake;          // posted with every command
+    Uint32 publishedEvent;  // pushed to the event queue after a publish
+    SDL_atomic_t notified;  // a publishedEvent is waiting in the queue
+    SDL_atomic_t running;
+    SDL_Thread *thread;
+} Simulation;
+
+int startSimulation(Simulation *sim, Grid *grid, SnapshotBuffer *snapshots, const Config *config, Uint32 publishedEvent);
+void stopSimulation(Simulation *sim);
+int sendCommand(Simulation *sim, CommandType type, int row, int col, int value);
+int sendStroke(Simulation *sim, int row, int col, int toRow, int toCol, int walkable);
+size_t drainTrace(Simulation *sim, TraceEvent *events, size_t capacity);
+
+#endif // SIMULATION_H
@@ -0,0 +1,116 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <SDL2/SDL_atomic.h>
+#include "astar.h"
+#include "grid.h"
+
+// What the renderer needs to know about a cell, one byte each. When a cell
+// has several, the later state in this list is the one shown.
+typedef enum {
+    CELL_FLOOR,
+    CELL_CLOSED,
+    CELL_OPEN,
+    CELL_WALL,
+    CELL_PATH,
+    CELL_START,
+    CELL_END,
+    CELL_STATE_COUNT
+} CellState;
+
+// Palette entry for each CellState, in CellState order: floor, closed, open,
+// wall, path, start, end. Palette entry 2 is the background.
+static const int STATE_COLORS[CELL_STATE_COUNT] = {1, 7, 6, 0, 5, 3, 4};
+
+// Flags cellState() packs into an index for its lookup table
+#define STATE_WALKABLE (1 << 0)
+#define STATE_CLOSED   (1 << 1)
+#define STATE_OPEN     (1 << 2)
+#define STATE_PATH     (1 << 3)
+#define STATE_START    (1 << 4)
+#define STATE_END      (1 << 5)
+#define STATE_FLAG_COMBINATIONS (1 << 6)
+
+// Heat levels are 0 for no work, then one per doubling of the count
+#define HEAT_LEVELS 8
+
+typedef struct {
+    uint8_t *states;    // one CellState per cell, row-major
+    int rows;
+    int cols;
+    unsigned int epoch; // publish count when this snapshot was written
+    unsigned int baseEpoch; // the changes lead from this epoch to this one
+    uint32_t *changes;  // cells that may differ from the snapshot at baseEpoch
+    size_t changeCount;
+    size_t changeCapacity;
+    int allChanged;     // too many changes to list, compare or redraw everything
+    uint8_t *heat;      // heat level per cell, row-major, valid while profiling
+    int profiling;      // the grid was counting search work
+    SearchStats stats;  // the search as of this snapshot
+} GridSnapshot;
+
+// Cells one publish changed, or ones a buffer missed while it was away
+typedef struct {
+    uint32_t *cells;
+    size_t count;
+    size_t capacity;
+    int overflow;       // lost track, treat every cell as listed
+    unsigned int epoch;
+} ChangeSet;
+
+#define SNAPSHOT_BUFFERS 3
+#define SNAPSHOT_HISTORY 4
+#define SNAPSHOT_INDEX 3
+#define SNAPSHOT_FRESH 4
+
+// A triple buffer between one thread that owns the grid and one that
+// draws. Publishing composes the grid's display state into the back
+// snapshot and swaps it into the middle slot; acquiring swaps the middle
+// slot out if it holds something newer. Both are a single atomic exchange,
+// so neither side ever waits for the other, and the reader only ever sees
+// finished snapshots. Only dirty cells are composed, along with the ones
+// the back buffer missed while the other two were being written.
+typedef struct {
+    GridSnapshot buffers[SNAPSHOT_BUFFERS];
+    SDL_atomic_t middle;    // buffer index, | SNAPSHOT_FRESH until acquired
+    SDL_atomic_t taken;     // epoch of the last snapshot acquired
+
+    // Writer side
+    int back;
+    int latest;             // last published, -1 before the first
+    unsigned int epoch;
+    ChangeSet missed[SNAPSHOT_BUFFERS];
+    ChangeSet history[SNAPSHOT_HISTORY]; // what each recent publish changed
+    SearchStats stats;      // copied into every snapshot published
+
+    // Reader side
+    int front;
+} SnapshotBuffer;
+
+int initSnapshots(SnapshotBuffer *snapshots, int rows, int cols);
+void freeSnapshots(SnapshotBuffer *snapshots);
+CellState cellState(const Grid *grid, int row, int col);
+void publishSnapshot(SnapshotBuffer *snapshots, Grid *grid);
+const GridSnapshot* acquireSnapshot(SnapshotBuffer *snapshots);
+
+// Whether something still showing epoch `shown` can catch up with the
+// snapshot by redrawing just its listed changes
+static inline int canApplyChanges(const GridSnapshot *snapshot, unsigned int shown) {
+    return !snapshot->allChanged && shown != 0 && snapshot->baseEpoch <= shown && shown < snapshot->epoch;
+}
+
+static inline uint8_t heatLevel(uint16_t count) {
+    uint8_t level = 0;
+    while (count != 0 && level < HEAT_LEVELS - 1) {
+        count >>= 1;
+        level++;
+    }
+    return level;
+}
+
+static inline CellState snapshotState(const GridSnapshot *snapshot, int row, int col) {
+    return (CellState)snapshot->states[(size_t)row * snapshot->cols + col];
+}
+
+#endif // SNAPSHOT_H
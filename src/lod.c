@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "lod.h"
+
+
+int initLod(LodPyramid *lod, int rows, int cols) {
+    lod->levels = 1;
+    lod->epoch = 0;
+    lod->states[0] = NULL;
+    lod->rows[0] = rows;
+    lod->cols[0] = cols;
+
+    // Halve, rounding up, until one block covers the whole grid
+    while ((lod->rows[lod->levels - 1] > 1 || lod->cols[lod->levels - 1] > 1) && lod->levels < MAX_LOD_LEVELS) {
+        int level = lod->levels++;
+        lod->rows[level] = (lod->rows[level - 1] + 1) / 2;
+        lod->cols[level] = (lod->cols[level - 1] + 1) / 2;
+        lod->states[level] = (uint8_t *)malloc((size_t)lod->rows[level] * lod->cols[level]);
+        if (lod->states[level] == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            freeLod(lod);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void freeLod(LodPyramid *lod) {
+    for (int level = 1; level < lod->levels; level++) {
+        free(lod->states[level]);
+        lod->states[level] = NULL;
+    }
+    lod->levels = 1;
+}
+
+// Highest state of the up to four cells below (row, col) of `level`
+static uint8_t blockState(const LodPyramid *lod, const GridSnapshot *snapshot, int level, int row, int col) {
+    const uint8_t *below = level == 1 ? snapshot->states : lod->states[level - 1];
+    int belowRows = lod->rows[level - 1];
+    int belowCols = lod->cols[level - 1];
+    int top = row * 2;
+    int left = col * 2;
+
+    uint8_t state = below[(size_t)top * belowCols + left];
+    if (left + 1 < belowCols && below[(size_t)top * belowCols + left + 1] > state) {
+        state = below[(size_t)top * belowCols + left + 1];
+    }
+    if (top + 1 < belowRows) {
+        const uint8_t *next = &below[(size_t)(top + 1) * belowCols];
+        if (next[left] > state) {
+            state = next[left];
+        }
+        if (left + 1 < belowCols && next[left + 1] > state) {
+            state = next[left + 1];
+        }
+    }
+    return state;
+}
+
+// Following on from an epoch the changes cover, only the blocks above its
+// changed cells are recomputed, stopping as soon as a level is unaffected;
+// otherwise every level is rebuilt from the one below
+void updateLod(LodPyramid *lod, const GridSnapshot *snapshot) {
+    if (lod->epoch == snapshot->epoch) {
+        return;
+    }
+
+    if (canApplyChanges(snapshot, lod->epoch)) {
+        for (size_t i = 0; i < snapshot->changeCount; i++) {
+            int row = (int)(snapshot->changes[i] / snapshot->cols);
+            int col = (int)(snapshot->changes[i] % snapshot->cols);
+            for (int level = 1; level < lod->levels; level++) {
+                row >>= 1;
+                col >>= 1;
+                uint8_t *state = &lod->states[level][(size_t)row * lod->cols[level] + col];
+                uint8_t updated = blockState(lod, snapshot, level, row, col);
+                if (*state == updated) {
+                    break;
+                }
+                *state = updated;
+            }
+        }
+    } else {
+        for (int level = 1; level < lod->levels; level++) {
+            for (int row = 0; row < lod->rows[level]; row++) {
+                for (int col = 0; col < lod->cols[level]; col++) {
+                    lod->states[level][(size_t)row * lod->cols[level] + col] = blockState(lod, snapshot, level, row, col);
+                }
+            }
+        }
+    }
+    lod->epoch = snapshot->epoch;
+}
@@ -2,127 +2,125 @@
 #include <stdlib.h>
 #include <SDL2/SDL.h>
 #include <math.h>
+#include <string.h>
+#include "bench.h"
+#include "camera.h"
 #include "color.h"
 #include "cursor.h"
 #include "cell.h"
+#include "config.h"
+#include "generate.h"
+#include "grid.h"
+#include "headless.h"
+#include "hud.h"
+#include "recording.h"
 #include "render.h"
+#include "simulation.h"
+#include "snapshot.h"
 
 #undef main
 
-const int WIDTH = 800;
-const int HEIGHT = 800;
-const int ROWS = 50;
-const int COLS = 50;
-const int SPACING = 2;
+// Longest the loop sleeps in the event queue when there is nothing to do
+#define IDLE_WAIT_MS 250
+// Zoom factor per mouse wheel notch
+#define ZOOM_STEP 1.25
 
-
-
-
-const Color COLORS[6] = {         
+const Color COLORS[8] = {         
     {217, 132, 108, 255},          // Unwalkable 217, 132, 108
     {60, 60, 60, 255},    // Walkable
     {0, 0, 0, 255},          //Background
     {0, 255, 0, 255},       // Start 148,192,142
     {224,93,99, 255},        // End 
-    {227, 187, 41, 255}      // Path
+    {227, 187, 41, 255},     // Path
+    {85, 130, 168, 255},     // Open
+    {70, 88, 104, 255}       // Closed
 };
 
 Cursor cursor = {
     0, 0, 1, {85,168,163, 220}
 };
 
+// Search events drained from the simulation since the last frame
+static TraceEvent traceEvents[TRACE_CAPACITY];
 
-
-
-void clearStartCells(Cell **grid, const int* rows, const int * cols);
-void clearEndCells(Cell **grid, const int* rows, const int * cols);
-void generateMaze(Cell **grid, int row, int col, int rows, int cols);
-void initializeMaze(Cell **grid, int rows, int cols);
-
-
-
-void clearStartCells(Cell **grid, const int* rows, const int * cols) {
-    for (int row = 0; row < *rows; row++) {
-        for (int col = 0; col < *cols; col++) {
-            grid[row][col].isStartCell = 0;
-        }
+// `main --write-maze file.pbm rows cols [seed]`
+static int writeMaze(const char *program, int argc, char *argv[]) {
+    int rows, cols;
+    uint64_t seed = 1;
+    if (argc < 3 || argc > 4) {
+        printUsage(program);
+        return 1;
     }
-}
-
-void clearEndCells(Cell **grid, const int* rows, const int * cols) {
-    for (int row = 0; row < *rows; row++) {
-        for (int col = 0; col < *cols; col++) {
-            grid[row][col].isEndCell = 0;
-        }
+    const char *invalid = NULL;
+    if (parseInt(argv[1], 1, &rows) != 0) {
+        invalid = argv[1];
+    } else if (parseInt(argv[2], 1, &cols) != 0) {
+        invalid = argv[2];
+    } else if (argc == 4 && parseSeed(argv[3], &seed) != 0) {
+        invalid = argv[3];
+    }
+    if (invalid != NULL) {
+        fprintf(stderr, "Invalid value '%s' for '--write-maze'\n", invalid);
+        printUsage(program);
+        return 1;
     }
+    return writeMazeFile(argv[0], rows, cols, seed) == 0 ? 0 : 1;
 }
 
-
-void generateMaze(Cell **grid, int row, int col, int rows, int cols) {
-    // Direction vectors for moving in 4 directions
-    int directions[4][2] = {
-        {0, 1}, // Right
-        {1, 0}, // Down
-        {0, -1}, // Left
-        {-1, 0} // Up
-    };
-
-    // Shuffle directions to ensure randomness
-    for (int i = 0; i < 4; i++) {
-        int r = rand() % 4;
-        int temp[2] = {directions[i][0], directions[i][1]};
-        directions[i][0] = directions[r][0];
-        directions[i][1] = directions[r][1];
-        directions[r][0] = temp[0];
-        directions[r][1] = temp[1];
+// Extends a paint drag to the cell under a pixel. The stroke runs from the
+// last cell it reached, so a fast drag leaves no gaps; until a command is
+// taken the stroke keeps its old end and the next call covers the gap.
+static void extendStroke(Simulation *sim, const Camera *camera, int rows, int cols, int *strokeRow, int *strokeCol, int pixelX, int pixelY, int walkable) {
+    int row = SDL_clamp(screenToRow(camera, pixelY), 0, rows - 1);
+    int col = SDL_clamp(screenToCol(camera, pixelX), 0, cols - 1);
+    if (*strokeRow < 0) {
+        *strokeRow = row;
+        *strokeCol = col;
+    } else if (row == *strokeRow && col == *strokeCol) {
+        return;
     }
-
-    for (int i = 0; i < 4; i++) {
-        int newRow = row + directions[i][0] * 2;
-        int newCol = col + directions[i][1] * 2;
-
-        if (newRow >= 0 && newRow < rows && newCol >= 0 && newCol < cols && grid[newRow][newCol].visited == 0) {
-            grid[newRow][newCol].walkable = 1;
-            grid[row + directions[i][0]][col + directions[i][1]].walkable = 1;
-            grid[newRow][newCol].visited = 1;
-
-            generateMaze(grid, newRow, newCol, rows, cols);
-        }
+    if (sendStroke(sim, *strokeRow, *strokeCol, row, col, walkable) == 0) {
+        *strokeRow = row;
+        *strokeCol = col;
     }
 }
 
 
-void initializeMaze(Cell **grid, int rows, int cols) {
-    for (int row = 0; row < rows; row++) {
-        for (int col = 0; col < cols; col++) {
-            grid[row][col].walkable = 0;
-            grid[row][col].visited = 0;
-        }
-    }
-
-    int startRow = rand() % rows;
-    int startCol = rand() % cols;
-
-    grid[startRow][startCol].walkable = 1;
-    grid[startRow][startCol].visited = 1;
-
-    generateMaze(grid, startRow, startCol, rows, cols);
-}
 
 
+int main(int argc, char *argv[]) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0) {
+        return runBenchmarks(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--render") == 0) {
+        return runHeadless(argc - 2, argv + 2, COLORS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--record") == 0) {
+        return runRecording(argc - 2, argv + 2, COLORS);
+    }
+    if (argc > 1 && strcmp(argv[1], "--play") == 0) {
+        return runPlayback(argc - 2, argv + 2);
+    }
+    if (argc > 1 && strcmp(argv[1], "--write-maze") == 0) {
+        return writeMaze(argv[0], argc - 2, argv + 2);
+    }
 
+    Config config;
+    defaultConfig(&config);
+    if (parseArgs(&config, argc, argv) != 0) {
+        return 1;
+    }
 
-int main(int argc, char *argv[]) {
     SDL_Init(SDL_INIT_EVERYTHING);
 
-    SDL_Window* window = SDL_CreateWindow("Path Finding", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WIDTH, HEIGHT, SDL_WINDOW_ALLOW_HIGHDPI);
+    SDL_Window* window = SDL_CreateWindow("Path Finding", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, config.width, config.height, SDL_WINDOW_ALLOW_HIGHDPI);
 
     if (window == NULL) {
         printf("Could not create window: %s\n", SDL_GetError());
         return 1;
     }
 
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
     if (renderer == NULL) {
         printf("Renderer could not be created! SDL_Error: %s\n", SDL_GetError());
         SDL_DestroyWindow(window);
@@ -134,71 +132,172 @@ int main(int argc, char *argv[]) {
 
     init(renderer, COLORS);
 
-    Cell **grid = (Cell **)malloc(ROWS * sizeof(Cell *));
-    for (int i = 0; i < ROWS; ++i) {
-        grid[i] = (Cell *)malloc(COLS * sizeof(Cell));
-        if (grid[i] == NULL) {
-            fprintf(stderr, "Memory allocation failed\n");
-            return 1;
-        }
-        for (int j = 0; j < COLS; ++j) {
-            grid[i][j].walkable = 1;
-            grid[i][j].gCost = 0;
-            grid[i][j].hCost = 0;
-            grid[i][j].fCost = 0;
-            grid[i][j].x = j;
-            grid[i][j].y = i;
-            grid[i][j].isStartCell = 0;
-            grid[i][j].isEndCell = 0;
-            grid[i][j].isPath = 0;
-            grid[i][j].isOpen = 0;
-            grid[i][j].isClosed = 0;
-            grid[i][j].visited = 0;
-            grid[i][j].parent = NULL;
-        }
+    Grid cells;
+    if (initGrid(&cells, config.rows, config.cols, config.layout) != 0) {
+        return 1;
+    }
+    Grid *grid = &cells;
+
+    // Search and edits write the grid on the simulation thread; this one
+    // only sees published snapshots
+    SnapshotBuffer snapshots;
+    if (initSnapshots(&snapshots, grid->rows, grid->cols) != 0) {
+        return 1;
+    }
+    Uint32 publishedEvent = SDL_RegisterEvents(1);
+    Simulation sim;
+    if (startSimulation(&sim, grid, &snapshots, &config, publishedEvent) != 0) {
+        return 1;
+    }
+    const GridSnapshot *snapshot = acquireSnapshot(&snapshots);
+
+    // Wheel zooms around the mouse, middle drag pans, Home fits the grid
+    Camera camera;
+    fitCamera(&camera, config.width, config.height, grid->rows, grid->cols);
+    int panning = 0;
+
+    // Zoomed-out frames draw from coarser levels instead of every cell
+    LodPyramid lodStorage;
+    LodPyramid *gridLod = NULL;
+    if (initLod(&lodStorage, grid->rows, grid->cols) == 0) {
+        gridLod = &lodStorage;
+    }
+
+    // Frames only redraw what changed into a persistent canvas when the
+    // renderer supports render targets
+    GridCanvas canvasStorage;
+    GridCanvas *gridCanvas = NULL;
+    if (initGridCanvas(&canvasStorage, renderer, config.width, config.height) == 0) {
+        gridCanvas = &canvasStorage;
     }
-    Cell** newGrid = grid;
 
-    render(renderer, grid, &cursor, COLORS, &WIDTH, &HEIGHT, &ROWS, &COLS, &SPACING);
+    // Texture mode draws the grid as one texel per cell; t switches modes
+    GridTexture textureStorage;
+    GridTexture *gridTexture = NULL;
+    if (config.texture && initGridTexture(&textureStorage, renderer, grid->rows, grid->cols) == 0) {
+        gridTexture = &textureStorage;
+    }
+
+    // Frame and search statistics in the corner; i toggles them
+    Hud hud;
+    initHud(&hud, config.hud);
 
     SDL_Event event;
     int running = 1;
-    int paused = 1;
     int ctrlPressed = 0;
     int leftMouseDown = 0;
     int rightMouseDown = 0;
-    Cell* startCell = NULL;
-    Cell* endCell = NULL;
+    int frameNeeded = 1;        // the cursor moved or the window needs a repaint
+    unsigned int shownEpoch = 0;
+    size_t traceCount = 0;
+    int strokeRow = -1;         // last cell the current paint drag reached, -1 for none
+    int strokeCol = -1;
 
     while (running) {
-        render(renderer, grid, &cursor, COLORS, &WIDTH, &HEIGHT, &ROWS, &COLS, &SPACING);
+        // Sleep in the event queue until input, a new snapshot or a repaint
+        int pending = frameNeeded ? SDL_PollEvent(&event) : SDL_WaitEventTimeout(&event, IDLE_WAIT_MS);
 
-        while (SDL_PollEvent(&event)) {
+        for (; pending; pending = SDL_PollEvent(&event)) {
+        if (event.type == publishedEvent) {
+            SDL_AtomicSet(&sim.notified, 0);
+            continue;
+        }
         switch (event.type) {
             case SDL_QUIT:
                 running = 0;
                 break;
 
             case SDL_KEYDOWN:
-                if (event.key.keysym.sym == SDLK_LCTRL) {
-                    ctrlPressed = 1;
-                } else if (event.key.keysym.sym == SDLK_m) {
-                    initializeMaze(grid, ROWS, COLS);
-                } else if (event.key.keysym.sym == SDLK_SPACE) {
-                    paused = !paused;
-                } else if (event.key.keysym.sym == SDLK_r) {
-                    randomizeGrid(grid, &ROWS, &COLS);
-                } else if (event.key.keysym.sym == SDLK_c) {
-                    resetGrid(grid, &ROWS, &COLS);
-                } else if (event.key.keysym.sym == SDLK_RIGHT) {
-                    updateGrid(&cursor, renderer, grid, COLORS, newGrid, &ROWS, &COLS, &SPACING, &WIDTH, &HEIGHT, startCell, endCell);
-                    Cell **temp = grid;
-                    grid = newGrid;
-                    newGrid = temp;
+                switch (event.key.keysym.sym) {
+                    case SDLK_LCTRL:
+                        ctrlPressed = 1;
+                        break;
+                    case SDLK_SPACE:
+                        sendCommand(&sim, COMMAND_PAUSE, 0, 0, 0);
+                        break;
+                    case SDLK_HOME:
+                        fitCamera(&camera, config.width, config.height, grid->rows, grid->cols);
+                        frameNeeded = 1;
+                        break;
+                    case SDLK_t:
+                        if (gridTexture != NULL) {
+                            freeGridTexture(gridTexture);
+                            gridTexture = NULL;
+                        } else if (initGridTexture(&textureStorage, renderer, grid->rows, grid->cols) == 0) {
+                            gridTexture = &textureStorage;
+                        }
+                        frameNeeded = 1;
+                        break;
+                    case SDLK_h:
+                        sendCommand(&sim, COMMAND_HEAT, 0, 0, 0);
+                        break;
+                    case SDLK_l:
+                        sendCommand(&sim, COMMAND_TRACE, 0, 0, 0);
+                        break;
+                    case SDLK_i:
+                        hud.visible = !hud.visible;
+                        frameNeeded = 1;
+                        break;
+                    case SDLK_RIGHT:
+                        sendCommand(&sim, COMMAND_FINISH, 0, 0, 0);
+                        break;
+                    case SDLK_m:
+                        sendCommand(&sim, COMMAND_MAZE, 0, 0, 0);
+                        break;
+                    case SDLK_e:
+                        sendCommand(&sim, COMMAND_ELLER, 0, 0, 0);
+                        break;
+                    case SDLK_r:
+                        sendCommand(&sim, COMMAND_RANDOM, 0, 0, 0);
+                        break;
+                    case SDLK_v:
+                        sendCommand(&sim, COMMAND_CAVES, 0, 0, 0);
+                        break;
+                    case SDLK_d:
+                        sendCommand(&sim, COMMAND_DUNGEON, 0, 0, 0);
+                        break;
+                    case SDLK_c:
+                        sendCommand(&sim, COMMAND_CLEAR, 0, 0, 0);
+                        break;
+                    default:
+                        break;
+                }
+                break;
+
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                // Target contents were lost, the next frame redraws it all
+                if (gridCanvas != NULL) {
+                    gridCanvas->epoch = 0;
+                }
+                if (gridTexture != NULL) {
+                    gridTexture->epoch = 0;
                 }
-                render(renderer, grid, &cursor, COLORS, &WIDTH, &HEIGHT, &ROWS, &COLS, &SPACING);
+                frameNeeded = 1;
                 break;
 
+            case SDL_WINDOWEVENT:
+                frameNeeded = 1;
+                break;
+
+            case SDL_MOUSEMOTION:
+                if (panning) {
+                    panCamera(&camera, event.motion.xrel, event.motion.yrel);
+                }
+                if (leftMouseDown != rightMouseDown) {
+                    extendStroke(&sim, &camera, grid->rows, grid->cols, &strokeRow, &strokeCol, event.motion.x, event.motion.y, rightMouseDown);
+                }
+                frameNeeded = 1;
+                break;
+
+            case SDL_MOUSEWHEEL: {
+                int mouseX, mouseY;
+                SDL_GetMouseState(&mouseX, &mouseY);
+                zoomCamera(&camera, pow(ZOOM_STEP, event.wheel.y), mouseX, mouseY);
+                frameNeeded = 1;
+                break;
+            }
+
             case SDL_KEYUP:
                 if (event.key.keysym.sym == SDLK_LCTRL) {
                     ctrlPressed = 0;
@@ -207,21 +306,21 @@ int main(int argc, char *argv[]) {
 
             case SDL_MOUSEBUTTONDOWN:
                 if (ctrlPressed && event.button.button == SDL_BUTTON_LEFT) {
-                    clearStartCells(grid, &ROWS, &COLS);
-                    grid[cursor.y][cursor.x].isStartCell = 1;
-                    startCell = &grid[cursor.y][cursor.x];
+                    sendCommand(&sim, COMMAND_SET_START, cursor.y, cursor.x, 0);
                 } else if (event.button.button == SDL_BUTTON_LEFT) {
                     leftMouseDown = 1;
                 }
 
                 if (ctrlPressed && event.button.button == SDL_BUTTON_RIGHT) {
-                    clearEndCells(grid, &ROWS, &COLS);
-                    grid[cursor.y][cursor.x].isEndCell = 1;
-                    endCell = &grid[cursor.y][cursor.x];
+                    sendCommand(&sim, COMMAND_SET_END, cursor.y, cursor.x, 0);
                 } else if (event.button.button == SDL_BUTTON_RIGHT) {
                     rightMouseDown = 1;
                 }
-                
+                if (event.button.button == SDL_BUTTON_MIDDLE) {
+                    panning = 1;
+                }
+                // Pressing either paint button starts a new stroke
+                strokeRow = -1;
                 break;
             case SDL_MOUSEBUTTONUP:
                 if (event.button.button == SDL_BUTTON_LEFT) {
@@ -230,38 +329,45 @@ int main(int argc, char *argv[]) {
                 if (event.button.button == SDL_BUTTON_RIGHT) {
                     rightMouseDown = 0;
                 }
+                if (event.button.button == SDL_BUTTON_MIDDLE) {
+                    panning = 0;
+                }
 
             }
         }
 
-        if (leftMouseDown && rightMouseDown) {
-            continue;
-        } else if (rightMouseDown) {
-            grid[cursor.y][cursor.x].walkable = 1;
-        } else if (leftMouseDown) {
-            grid[cursor.y][cursor.x].walkable = 0;
-        }
-        
-
-        if (!paused) {
-            updateGrid(&cursor, renderer, grid, COLORS, newGrid, &ROWS, &COLS, &SPACING, &WIDTH, &HEIGHT, startCell, endCell);
+        snapshot = acquireSnapshot(&snapshots);
+        traceCount += drainTrace(&sim, traceEvents + traceCount, TRACE_CAPACITY - traceCount);
 
-            Cell **temp = grid;
-            grid = newGrid;
-            newGrid = temp;
-
-            render(renderer, grid, &cursor, COLORS, &WIDTH, &HEIGHT, &ROWS, &COLS, &SPACING);
+        // Motion events paint the drag; this catches the press itself and
+        // the cell under a still mouse changing as the camera moves
+        if (leftMouseDown != rightMouseDown) {
+            int mouseX, mouseY;
+            SDL_GetMouseState(&mouseX, &mouseY);
+            extendStroke(&sim, &camera, grid->rows, grid->cols, &strokeRow, &strokeCol, mouseX, mouseY, rightMouseDown);
+        }
 
-            SDL_Delay(50);
+        // Present waits for vsync, which paces frames to the display
+        if (frameNeeded || snapshot->epoch != shownEpoch || traceCount > 0) {
+            render(renderer, snapshot, gridLod, &camera, gridCanvas, gridTexture, traceEvents, traceCount, &hud, &cursor, COLORS, &config.width, &config.height, &config.spacing);
+            shownEpoch = snapshot->epoch;
+            traceCount = 0;
+            frameNeeded = 0;
         }
     }
 
-    for (int i = 0; i < COLS; ++i) {
-        free(grid[i]);
-        free(newGrid[i]);
+    stopSimulation(&sim);
+    if (gridTexture != NULL) {
+        freeGridTexture(gridTexture);
+    }
+    if (gridCanvas != NULL) {
+        freeGridCanvas(gridCanvas);
+    }
+    if (gridLod != NULL) {
+        freeLod(gridLod);
     }
-    free(grid);
-    free(newGrid);
+    freeSnapshots(&snapshots);
+    freeGrid(&cells);
 
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
@@ -0,0 +1,50 @@
+#include <SDL2/SDL.h>
+#include "parallel.h"
+
+typedef struct {
+    TileJob job;
+    void *context;
+    int tileCount;
+    SDL_atomic_t next;
+} TileQueue;
+
+
+static int tileWorker(void *data) {
+    TileQueue *queue = (TileQueue *)data;
+    int tile;
+    while ((tile = SDL_AtomicAdd(&queue->next, 1)) < queue->tileCount) {
+        queue->job(queue->context, tile);
+    }
+    return 0;
+}
+
+int defaultThreadCount(void) {
+    int count = SDL_GetCPUCount();
+    return SDL_clamp(count, 1, MAX_THREADS);
+}
+
+// Runs job once for every tile on up to `threads` threads, the calling
+// thread included, and returns when all tiles are done. Tiles are handed
+// out in order from a shared counter; which thread runs a tile never
+// changes what the tile produces.
+void runTiles(int tileCount, int threads, TileJob job, void *context) {
+    TileQueue queue;
+    queue.job = job;
+    queue.context = context;
+    queue.tileCount = tileCount;
+    SDL_AtomicSet(&queue.next, 0);
+
+    SDL_Thread *workers[MAX_THREADS];
+    int spawned = 0;
+    for (int i = 1; i < threads && i < tileCount && i < MAX_THREADS; i++) {
+        SDL_Thread *worker = SDL_CreateThread(tileWorker, "tiles", &queue);
+        if (worker != NULL) {
+            workers[spawned++] = worker;
+        }
+    }
+
+    tileWorker(&queue);
+    for (int i = 0; i < spawned; i++) {
+        SDL_WaitThread(workers[i], NULL);
+    }
+}
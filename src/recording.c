@@ -0,0 +1,349 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "astar.h"
+#include "config.h"
+#include "generate.h"
+#include "grid.h"
+#include "image.h"
+#include "parallel.h"
+#include "recording.h"
+
+// Search progress as an animation, run with
+// `main --record file.frames [rows] [cols] [map] [seed] [expansions per frame]`
+// and turned into images with `main --play file.frames prefix [cell px]`.
+//
+// The file is a header followed by frames, all little-endian:
+//   "PFRM", u32 version, u32 rows, u32 cols, u32 expansions per frame,
+//   8 palette entries of r, g, b
+// Every frame is a list of runs ended by one with length 0:
+//   u32 first cell (row * cols + col), u16 length, length CellStates
+// The first frame is against a grid of CELL_FLOOR, each later one against
+// the frame before it.
+
+#define RECORD_DENSITY 0.3
+#define RECORD_EXPANSIONS 100
+
+
+static void putU16(uint8_t *bytes, uint32_t value) {
+    bytes[0] = (uint8_t)value;
+    bytes[1] = (uint8_t)(value >> 8);
+}
+
+static void putU32(uint8_t *bytes, uint32_t value) {
+    putU16(bytes, value);
+    putU16(bytes + 2, value >> 16);
+}
+
+static uint32_t getU16(const uint8_t *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8;
+}
+
+static uint32_t getU32(const uint8_t *bytes) {
+    return getU16(bytes) | getU16(bytes + 2) << 16;
+}
+
+int openFrameWriter(FrameWriter *writer, const char *path, int rows, int cols, uint32_t expansionsPerFrame, const Color* colors) {
+    if ((size_t)rows * cols > UINT32_MAX) {
+        fprintf(stderr, "Grid %dx%d is too big to record\n", rows, cols);
+        return -1;
+    }
+    writer->rows = rows;
+    writer->cols = cols;
+    writer->epoch = 0;
+    writer->frames = 0;
+    writer->sortedCapacity = 0;
+    writer->sorted = NULL;
+    writer->previous = (uint8_t *)calloc((size_t)rows * cols, sizeof(uint8_t));
+    if (writer->previous == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return -1;
+    }
+    writer->file = fopen(path, "wb");
+    if (writer->file == NULL) {
+        fprintf(stderr, "Could not open '%s' for writing\n", path);
+        free(writer->previous);
+        return -1;
+    }
+
+    uint8_t header[20 + 8 * 3];
+    memcpy(header, FRAMES_MAGIC, 4);
+    putU32(header + 4, FRAMES_VERSION);
+    putU32(header + 8, (uint32_t)rows);
+    putU32(header + 12, (uint32_t)cols);
+    putU32(header + 16, expansionsPerFrame);
+    for (int i = 0; i < 8; i++) {
+        header[20 + i * 3] = colors[i].r;
+        header[21 + i * 3] = colors[i].g;
+        header[22 + i * 3] = colors[i].b;
+    }
+    fwrite(header, 1, sizeof(header), writer->file);
+    writer->bytes = sizeof(header);
+    return 0;
+}
+
+// Cells of a run are consecutive, so the states go straight out of the
+// snapshot
+static void writeRun(FrameWriter *writer, const GridSnapshot *snapshot, uint32_t first, uint32_t length) {
+    uint8_t head[6];
+    putU32(head, first);
+    putU16(head + 4, length);
+    fwrite(head, 1, sizeof(head), writer->file);
+    fwrite(&snapshot->states[first], 1, length, writer->file);
+    memcpy(&writer->previous[first], &snapshot->states[first], length);
+    writer->bytes += sizeof(head) + length;
+}
+
+typedef struct {
+    uint32_t first;
+    uint32_t length;
+} Run;
+
+// Grows the open run with a changed cell, or writes it out and starts a
+// new one
+static void addToRun(FrameWriter *writer, const GridSnapshot *snapshot, Run *run, uint32_t cell) {
+    if (run->length > 0 && cell == run->first + run->length && run->length < FRAMES_MAX_RUN) {
+        run->length++;
+        return;
+    }
+    if (run->length > 0) {
+        writeRun(writer, snapshot, run->first, run->length);
+    }
+    run->first = cell;
+    run->length = 1;
+}
+
+static int compareCells(const void *a, const void *b) {
+    uint32_t left = *(const uint32_t *)a;
+    uint32_t right = *(const uint32_t *)b;
+    return (left > right) - (left < right);
+}
+
+// Following on from the last frame's snapshot only the listed changes are
+// compared, in cell order so neighbours merge into runs; otherwise every
+// cell is
+int writeFrame(FrameWriter *writer, const GridSnapshot *snapshot) {
+    Run run = {0, 0};
+    if (canApplyChanges(snapshot, writer->epoch)) {
+        if (snapshot->changeCount > writer->sortedCapacity) {
+            uint32_t *sorted = (uint32_t *)realloc(writer->sorted, snapshot->changeCount * sizeof(uint32_t));
+            if (sorted == NULL) {
+                fprintf(stderr, "Memory allocation failed\n");
+                return -1;
+            }
+            writer->sorted = sorted;
+            writer->sortedCapacity = snapshot->changeCount;
+        }
+        memcpy(writer->sorted, snapshot->changes, snapshot->changeCount * sizeof(uint32_t));
+        qsort(writer->sorted, snapshot->changeCount, sizeof(uint32_t), compareCells);
+        for (size_t i = 0; i < snapshot->changeCount; i++) {
+            uint32_t cell = writer->sorted[i];
+            if ((i == 0 || cell != writer->sorted[i - 1]) && snapshot->states[cell] != writer->previous[cell]) {
+                addToRun(writer, snapshot, &run, cell);
+            }
+        }
+    } else {
+        uint32_t cells = (uint32_t)writer->rows * (uint32_t)writer->cols;
+        for (uint32_t cell = 0; cell < cells; cell++) {
+            if (snapshot->states[cell] != writer->previous[cell]) {
+                addToRun(writer, snapshot, &run, cell);
+            }
+        }
+    }
+    if (run.length > 0) {
+        writeRun(writer, snapshot, run.first, run.length);
+    }
+
+    uint8_t end[6] = {0};
+    fwrite(end, 1, sizeof(end), writer->file);
+    writer->bytes += sizeof(end);
+    writer->epoch = snapshot->epoch;
+    writer->frames++;
+    return ferror(writer->file) ? -1 : 0;
+}
+
+int closeFrameWriter(FrameWriter *writer) {
+    int result = ferror(writer->file) ? -1 : 0;
+    if (fclose(writer->file) != 0) {
+        result = -1;
+    }
+    free(writer->previous);
+    free(writer->sorted);
+    writer->previous = NULL;
+    writer->sorted = NULL;
+    return result;
+}
+
+int runRecording(int argc, char *argv[], const Color* colors) {
+    MapKind map = MAP_MAZE;
+    int rows = 256;
+    int cols = 0;
+    uint64_t seed = 1;
+    int expansions = RECORD_EXPANSIONS;
+    if (argc > 3 && parseMap(argv[3], &map) != 0) {
+        return 1;
+    }
+    if (argc < 1 || (argc > 1 && parseInt(argv[1], 1, &rows) != 0) || (argc > 2 && parseInt(argv[2], 1, &cols) != 0)
+        || (argc > 4 && parseSeed(argv[4], &seed) != 0) || (argc > 5 && parseInt(argv[5], 1, &expansions) != 0)) {
+        fprintf(stderr, "Usage: main --record file.frames [rows] [cols] [random|maze|cave|dungeon] [seed] [expansions per frame]\n");
+        return 1;
+    }
+    if (cols == 0) {
+        cols = rows;
+    }
+
+    Grid grid;
+    if (initGrid(&grid, rows, cols, LAYOUT_ROW_MAJOR) != 0) {
+        return 1;
+    }
+    SnapshotBuffer snapshots;
+    if (initSnapshots(&snapshots, rows, cols) != 0) {
+        freeGrid(&grid);
+        return 1;
+    }
+    FrameWriter writer;
+    if (openFrameWriter(&writer, argv[0], rows, cols, (uint32_t)expansions, colors) != 0) {
+        freeSnapshots(&snapshots);
+        freeGrid(&grid);
+        return 1;
+    }
+
+    Rng rng;
+    seedRng(&rng, seed);
+    generateMap(&grid, &rng, map, RECORD_DENSITY, defaultThreadCount());
+    Cell *startCell = firstWalkable(&grid);
+    Cell *endCell = lastWalkable(&grid);
+    int result = 0;
+    if (startCell != NULL && endCell != NULL) {
+        startCell->isStartCell = 1;
+        endCell->isEndCell = 1;
+        Search search;
+        initSearch(&search);
+        startSearch(&search, &grid, startCell, endCell);
+        while (result == 0 && search.status == SEARCH_RUNNING) {
+            stepSearch(&search, (size_t)expansions);
+            publishSnapshot(&snapshots, &grid);
+            result = writeFrame(&writer, acquireSnapshot(&snapshots));
+        }
+        stopSearch(&search);
+    } else {
+        publishSnapshot(&snapshots, &grid);
+        result = writeFrame(&writer, acquireSnapshot(&snapshots));
+    }
+
+    size_t frames = writer.frames;
+    size_t bytes = writer.bytes;
+    if (closeFrameWriter(&writer) != 0) {
+        result = -1;
+    }
+    if (result == 0) {
+        printf("Wrote %s: %zu frames of a %s map %dx%d, %zu bytes\n", argv[0], frames, mapName(map), rows, cols, bytes);
+    }
+    freeSnapshots(&snapshots);
+    freeGrid(&grid);
+    return result == 0 ? 0 : 1;
+}
+
+// Applies one frame's runs to the states; 0 at the end of the file
+static int readFrame(FILE *file, uint8_t *states, uint32_t cells) {
+    uint8_t head[6];
+    int runs = 0;
+    while (fread(head, 1, sizeof(head), file) == sizeof(head)) {
+        uint32_t first = getU32(head);
+        uint32_t length = getU16(head + 4);
+        if (length == 0) {
+            return 1;
+        }
+        if (first > cells || length > cells - first || fread(&states[first], 1, length, file) != length) {
+            break;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+            if (states[first + i] >= CELL_STATE_COUNT) {
+                fprintf(stderr, "Frame file is damaged\n");
+                return -1;
+            }
+        }
+        runs++;
+    }
+    if (runs > 0 || !feof(file)) {
+        fprintf(stderr, "Frame file is damaged\n");
+        return -1;
+    }
+    return 0;
+}
+
+// Replays a recording into numbered images, one frame in memory at a time
+int runPlayback(int argc, char *argv[]) {
+    int cellPixels = 0;
+    if (argc < 2 || (argc > 2 && parseInt(argv[2], 1, &cellPixels) != 0)) {
+        fprintf(stderr, "Usage: main --play file.frames prefix [cell px]\n");
+        return 1;
+    }
+    FILE *file = fopen(argv[0], "rb");
+    if (file == NULL) {
+        fprintf(stderr, "Could not open '%s'\n", argv[0]);
+        return 1;
+    }
+    uint8_t header[20 + 8 * 3];
+    if (fread(header, 1, sizeof(header), file) != sizeof(header) || memcmp(header, FRAMES_MAGIC, 4) != 0 || getU32(header + 4) != FRAMES_VERSION) {
+        fprintf(stderr, "'%s' is not a frame file\n", argv[0]);
+        fclose(file);
+        return 1;
+    }
+
+    Color colors[8];
+    for (int i = 0; i < 8; i++) {
+        colors[i].r = header[20 + i * 3];
+        colors[i].g = header[21 + i * 3];
+        colors[i].b = header[22 + i * 3];
+        colors[i].a = 255;
+    }
+    // Same limits openFrameWriter() applies; anything else is not ours
+    uint32_t rows = getU32(header + 8);
+    uint32_t cols = getU32(header + 12);
+    if (rows == 0 || cols == 0 || rows > INT_MAX || cols > INT_MAX || (uint64_t)rows * cols > UINT32_MAX) {
+        fprintf(stderr, "'%s' has an invalid grid size of %ux%u\n", argv[0], rows, cols);
+        fclose(file);
+        return 1;
+    }
+    GridSnapshot frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.rows = (int)rows;
+    frame.cols = (int)cols;
+    if (cellPixels == 0) {
+        cellPixels = defaultCellPixels(frame.rows, frame.cols);
+    }
+    uint32_t cells = rows * cols;
+    frame.states = (uint8_t *)calloc(cells, sizeof(uint8_t));
+    Image image;
+    // initImage() refuses images too large to address
+    if (frame.states == NULL || initImage(&image, frame.rows, frame.cols, cellPixels, IMAGE_SPACING) != 0) {
+        fprintf(stderr, "Could not set up %dx%d frames\n", frame.rows, frame.cols);
+        free(frame.states);
+        fclose(file);
+        return 1;
+    }
+
+    int threads = defaultThreadCount();
+    int result;
+    size_t count = 0;
+    char path[1024];
+    while ((result = readFrame(file, frame.states, cells)) > 0) {
+        drawImage(&image, &frame, colors, threads);
+        snprintf(path, sizeof(path), "%s%06zu.png", argv[1], count++);
+        if (writeImage(&image, path) != 0) {
+            result = -1;
+            break;
+        }
+    }
+    if (result == 0) {
+        printf("Wrote %zu frames of %dx%d px\n", count, image.width, image.height);
+    }
+
+    freeImage(&image);
+    free(frame.states);
+    fclose(file);
+    return result == 0 ? 0 : 1;
+}
@@ -1,3 +1,6 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "render.h"
 #include "astar.h"
 
@@ -11,136 +14,423 @@ SDL_Renderer* init(SDL_Renderer* renderer, const Color* colors) {
 }
 
 
-void updateGrid(Cursor* cursor, SDL_Renderer *renderer, Cell **grid, const Color* colors, Cell **newGrid, const int* rows, const int* cols, const int* spacing, const int* width, const int* height, Cell *startCell, Cell *endCell) {
-    if (!startCell && !endCell) {
+// Gaps between cells only show while cells are wider than them
+static int cellGap(const Camera *camera, const int* spacing) {
+    return (int)camera->scale > *spacing ? *spacing : 0;
+}
+
+
+// Cells are queued per colour and drawn with one SDL_RenderFillRects call
+// per colour, instead of a colour change and a draw call for every cell.
+// Grid cells never overlap, so flushing one colour early when its batch is
+// full does not change the picture.
+#define BATCH_SIZE 4096
+#define BATCH_COLORS 8
+
+typedef struct {
+    SDL_Rect rects[BATCH_SIZE];
+    int count;
+} RectBatch;
+
+static RectBatch batches[BATCH_COLORS];
+
+static void flushBatch(SDL_Renderer *renderer, const Color *colors, int color) {
+    RectBatch *batch = &batches[color];
+    if (batch->count > 0) {
+        SDL_SetRenderDrawColor(renderer, colors[color].r, colors[color].g, colors[color].b, colors[color].a);
+        SDL_RenderFillRects(renderer, batch->rects, batch->count);
+        batch->count = 0;
+    }
+}
+
+static inline void batchRect(SDL_Renderer *renderer, const Color *colors, int color, int x, int y, int w, int h) {
+    RectBatch *batch = &batches[color];
+    if (batch->count == BATCH_SIZE) {
+        flushBatch(renderer, colors, color);
+    }
+    SDL_Rect *rect = &batch->rects[batch->count++];
+    rect->x = x;
+    rect->y = y;
+    rect->w = w;
+    rect->h = h;
+}
+
+static void flushBatches(SDL_Renderer *renderer, const Color *colors) {
+    for (int color = 0; color < BATCH_COLORS; color++) {
+        flushBatch(renderer, colors, color);
+    }
+}
+
+
+// Queues the screen rect of the step x step block of cells at (row, col)
+static inline void batchCell(SDL_Renderer *renderer, const Color *colors, int color, const Camera *camera, int row, int col, int step, int gap) {
+    int x = cellScreenX(camera, col);
+    int y = cellScreenY(camera, row);
+    int w = cellScreenX(camera, col + step) - x - gap;
+    int h = cellScreenY(camera, row + step) - y - gap;
+    batchRect(renderer, colors, color, x, y, w > 0 ? w : 1, h > 0 ? h : 1);
+}
+
+// One pass over the cells in view; the colour comes straight from the
+// state, so walls, search sets, path and endpoints all go out together.
+// Zoomed out past a cell per pixel, the blocks of the LOD level that fits
+// are drawn instead, or without levels one sample cell per step x step
+// block. Either way a frame stays at about one rect per pixel.
+void drawGrid(SDL_Renderer *renderer, const GridSnapshot *snapshot, const LodPyramid *lod, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing) {
+    CellWindow view = visibleWindow(camera, *width, *height, snapshot->rows, snapshot->cols);
+    int step = cellStep(camera);
+    int gap = cellGap(camera, spacing);
+
+    int level = lod != NULL ? lodLevel(lod, camera->scale) : 0;
+    if (level > 0) {
+        int block = 1 << level;
+        for (int row = view.top >> level; row < (view.bottom + block - 1) >> level; row++) {
+            for (int col = view.left >> level; col < (view.right + block - 1) >> level; col++) {
+                batchCell(renderer, colors, STATE_COLORS[lodState(lod, level, row, col)], camera, row << level, col << level, block, gap);
+            }
+        }
+        flushBatches(renderer, colors);
+        return;
+    }
+
+    for (int row = view.top; row < view.bottom; row += step) {
+        const uint8_t *states = &snapshot->states[(size_t)row * snapshot->cols];
+        for (int col = view.left; col < view.right; col += step) {
+            batchCell(renderer, colors, STATE_COLORS[states[col]], camera, row, col, step, gap);
+        }
+    }
+    flushBatches(renderer, colors);
+}
+
+// Redraws only the cells the snapshot lists as changed since the one
+// before it, on top of a target that already shows that earlier snapshot
+// through the same camera. At an LOD level it is the blocks holding them.
+void drawCells(SDL_Renderer *renderer, const GridSnapshot *snapshot, const LodPyramid *lod, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing) {
+    CellWindow view = visibleWindow(camera, *width, *height, snapshot->rows, snapshot->cols);
+    int step = cellStep(camera);
+    int gap = cellGap(camera, spacing);
+
+    int level = lod != NULL ? lodLevel(lod, camera->scale) : 0;
+    if (level > 0) {
+        for (size_t i = 0; i < snapshot->changeCount; i++) {
+            int row = (int)(snapshot->changes[i] / snapshot->cols);
+            int col = (int)(snapshot->changes[i] % snapshot->cols);
+            // A change just off screen can still be in a block that shows
+            int blockRow = row >> level << level;
+            int blockCol = col >> level << level;
+            if (blockRow < view.bottom && blockRow + (1 << level) > view.top && blockCol < view.right && blockCol + (1 << level) > view.left) {
+                int state = lodState(lod, level, row >> level, col >> level);
+                batchCell(renderer, colors, STATE_COLORS[state], camera, blockRow, blockCol, 1 << level, gap);
+            }
+        }
+        flushBatches(renderer, colors);
+        return;
+    }
+
+    for (size_t i = 0; i < snapshot->changeCount; i++) {
+        uint32_t index = snapshot->changes[i];
+        int row = (int)(index / snapshot->cols);
+        int col = (int)(index % snapshot->cols);
+        // Only cells drawGrid() samples are on screen
+        if (row >= view.top && row < view.bottom && col >= view.left && col < view.right
+            && (row - view.top) % step == 0 && (col - view.left) % step == 0) {
+            batchCell(renderer, colors, STATE_COLORS[snapshot->states[index]], camera, row, col, step, gap);
+        }
+    }
+    flushBatches(renderer, colors);
+}
+
+int initGridCanvas(GridCanvas *canvas, SDL_Renderer *renderer, int width, int height) {
+    canvas->epoch = 0;
+    memset(&canvas->camera, 0, sizeof(canvas->camera));
+    canvas->target = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+    if (canvas->target == NULL) {
+        fprintf(stderr, "Could not create render target, redrawing every frame: %s\n", SDL_GetError());
+        return -1;
+    }
+    SDL_SetTextureBlendMode(canvas->target, SDL_BLENDMODE_NONE);
+    return 0;
+}
+
+void freeGridCanvas(GridCanvas *canvas) {
+    if (canvas->target != NULL) {
+        SDL_DestroyTexture(canvas->target);
+        canvas->target = NULL;
+    }
+}
+
+// Brings the canvas up to the snapshot: nothing if it already shows it,
+// the listed changes if it shows an epoch they cover through the same camera,
+// everything otherwise
+static void updateGridCanvas(SDL_Renderer *renderer, GridCanvas *canvas, const GridSnapshot *snapshot, const LodPyramid *lod, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing) {
+    int sameCamera = sameView(&canvas->camera, camera);
+    if (canvas->epoch == snapshot->epoch && sameCamera) {
         return;
     }
 
-    astar(cursor, renderer, colors, grid, startCell, endCell, width, height, rows, cols, spacing);
+    SDL_SetRenderTarget(renderer, canvas->target);
+    if (canApplyChanges(snapshot, canvas->epoch) && sameCamera) {
+        drawCells(renderer, snapshot, lod, camera, colors, width, height, spacing);
+    } else {
+        SDL_SetRenderDrawColor(renderer, colors[2].r, colors[2].g, colors[2].b, colors[2].a);
+        SDL_RenderClear(renderer);
+        drawGrid(renderer, snapshot, lod, camera, colors, width, height, spacing);
+    }
+    SDL_SetRenderTarget(renderer, NULL);
+    canvas->epoch = snapshot->epoch;
+    canvas->camera = *camera;
 }
 
+int initGridTexture(GridTexture *gridTexture, SDL_Renderer *renderer, int rows, int cols) {
+    SDL_RendererInfo info;
+    gridTexture->texture = NULL;
+    gridTexture->pixels = NULL;
+    gridTexture->states = NULL;
+    gridTexture->rows = rows;
+    gridTexture->cols = cols;
+
+    if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0
+        && (cols > info.max_texture_width || rows > info.max_texture_height)) {
+        fprintf(stderr, "Grid too large for a %dx%d texture\n", info.max_texture_width, info.max_texture_height);
+        return -1;
+    }
+
+    gridTexture->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, cols, rows);
+    if (gridTexture->texture == NULL) {
+        fprintf(stderr, "Could not create grid texture: %s\n", SDL_GetError());
+        return -1;
+    }
+
+    size_t cells = (size_t)rows * cols;
+    gridTexture->pixels = (Uint32 *)malloc(cells * sizeof(Uint32));
+    gridTexture->states = (uint8_t *)malloc(cells);
+    if (gridTexture->pixels == NULL || gridTexture->states == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        freeGridTexture(gridTexture);
+        return -1;
+    }
+    // No state matches, so the first update writes every texel
+    memset(gridTexture->states, 0xFF, cells);
+    gridTexture->epoch = 0;
+    return 0;
+}
+
+void freeGridTexture(GridTexture *gridTexture) {
+    if (gridTexture->texture != NULL) {
+        SDL_DestroyTexture(gridTexture->texture);
+        gridTexture->texture = NULL;
+    }
+    free(gridTexture->pixels);
+    free(gridTexture->states);
+    gridTexture->pixels = NULL;
+    gridTexture->states = NULL;
+}
 
+// Rewrites the texels whose state changed and uploads the band of rows
+// that contains them. Following on from an epoch they cover that is just
+// its change list; otherwise unchanged rows are skipped with a memcmp.
+void updateGridTexture(GridTexture *gridTexture, const GridSnapshot *snapshot, const Color* colors) {
+    Uint32 palette[CELL_STATE_COUNT];
+    for (int state = 0; state < CELL_STATE_COUNT; state++) {
+        const Color *color = &colors[STATE_COLORS[state]];
+        palette[state] = (Uint32)color->a << 24 | (Uint32)color->r << 16 | (Uint32)color->g << 8 | color->b;
+    }
 
-void drawGrid(SDL_Renderer *renderer, Cell **grid, const Color* colors, const int* width, const int* height, const int* rows, const int* cols, const int* spacing) {
-    int cellWidth = (*width) / *cols;
-    int cellHeight = (*height) / *rows;
+    int cols = gridTexture->cols;
+    int firstRow = -1;
+    int lastRow = -1;
+    if (gridTexture->epoch == snapshot->epoch) {
+        return;
+    } else if (canApplyChanges(snapshot, gridTexture->epoch)) {
+        for (size_t i = 0; i < snapshot->changeCount; i++) {
+            uint32_t index = snapshot->changes[i];
+            int row = (int)(index / cols);
+            gridTexture->states[index] = snapshot->states[index];
+            gridTexture->pixels[index] = palette[snapshot->states[index]];
+            firstRow = firstRow < 0 || row < firstRow ? row : firstRow;
+            lastRow = row > lastRow ? row : lastRow;
+        }
+    } else {
+        for (int row = 0; row < gridTexture->rows; row++) {
+            const uint8_t *source = &snapshot->states[(size_t)row * cols];
+            uint8_t *shown = &gridTexture->states[(size_t)row * cols];
+            if (memcmp(source, shown, cols) == 0) {
+                continue;
+            }
 
-    for (int row = 0; row < *rows; ++row) {
-        for (int col = 0; col < *cols; ++col) {
-            if (grid[row][col].isStartCell) {
-                SDL_SetRenderDrawColor(renderer, colors[3].r, colors[3].g, colors[3].b, colors[3].a);
-            } else if (grid[row][col].isEndCell) {
-                SDL_SetRenderDrawColor(renderer, colors[4].r, colors[4].g, colors[4].b, colors[4].a);
-            } else {
-                SDL_SetRenderDrawColor(renderer, colors[grid[row][col].walkable].r, colors[grid[row][col].walkable].g, colors[grid[row][col].walkable].b, colors[grid[row][col].walkable].a);
+            Uint32 *pixels = &gridTexture->pixels[(size_t)row * cols];
+            for (int col = 0; col < cols; col++) {
+                if (source[col] != shown[col]) {
+                    shown[col] = source[col];
+                    pixels[col] = palette[source[col]];
+                }
+            }
+            if (firstRow < 0) {
+                firstRow = row;
             }
-            
-            SDL_Rect cell = {col * cellWidth, row * cellHeight, cellWidth - *spacing, cellHeight - *spacing};
-            SDL_RenderFillRect(renderer, &cell);
+            lastRow = row;
+        }
+    }
+    gridTexture->epoch = snapshot->epoch;
+
+    if (firstRow >= 0) {
+        SDL_Rect band = {0, firstRow, cols, lastRow - firstRow + 1};
+        SDL_UpdateTexture(gridTexture->texture, &band, &gridTexture->pixels[(size_t)firstRow * cols], cols * (int)sizeof(Uint32));
+    }
+}
+
+// One copy of the cells in view, scaled by the GPU. While cells are wider
+// than the spacing, background strips between them recreate the gaps of
+// the rect renderer.
+void drawGridTexture(SDL_Renderer *renderer, GridTexture *gridTexture, const GridSnapshot *snapshot, const Camera *camera, const Color* colors, const int* width, const int* height, const int* spacing) {
+    updateGridTexture(gridTexture, snapshot, colors);
+
+    CellWindow view = visibleWindow(camera, *width, *height, snapshot->rows, snapshot->cols);
+    SDL_Rect source = {view.left, view.top, view.right - view.left, view.bottom - view.top};
+    SDL_Rect target = {cellScreenX(camera, view.left), cellScreenY(camera, view.top), 0, 0};
+    target.w = cellScreenX(camera, view.right) - target.x;
+    target.h = cellScreenY(camera, view.bottom) - target.y;
+    SDL_RenderCopy(renderer, gridTexture->texture, &source, &target);
+
+    int gap = cellGap(camera, spacing);
+    if (gap > 0) {
+        for (int col = view.left; col < view.right; col++) {
+            batchRect(renderer, colors, 2, cellScreenX(camera, col + 1) - gap, target.y, gap, target.h);
+        }
+        for (int row = view.top; row < view.bottom; row++) {
+            batchRect(renderer, colors, 2, target.x, cellScreenY(camera, row + 1) - gap, target.w, gap);
         }
+        flushBatches(renderer, colors);
     }
 }
 
-void drawPath(SDL_Renderer* renderer, Cell **grid, const Color* colors, const int* width, const int* height, const int* rows, const int* cols, const int* spacing) {
-    int cellWidth = (*width) / *cols;
-    int cellHeight = (*height) / *rows;
+// Cold to hot, one per heat level; level 0 is not drawn
+static const Color HEAT_COLORS[HEAT_LEVELS] = {
+    {0, 0, 0, 0},
+    {40, 30, 130, 170},
+    {90, 30, 160, 180},
+    {160, 40, 140, 190},
+    {215, 60, 90, 200},
+    {245, 110, 40, 210},
+    {250, 180, 30, 220},
+    {255, 245, 150, 230}
+};
 
-    for (int row = 0; row < *rows; ++row) {
-        for (int col = 0; col < *cols; ++col) {
-            if (grid[row][col].isPath) {
-                SDL_SetRenderDrawColor(renderer, colors[5].r, colors[5].g, colors[5].b, colors[5].a);
-                SDL_Rect cell = {col * cellWidth, row * cellHeight, cellWidth - *spacing, cellHeight - *spacing};
-                SDL_RenderFillRect(renderer, &cell);
+// Colours every cell in view by how much search work it has taken, over
+// whatever the grid shows. Zoomed out it samples one cell per step x step
+// block, like drawGrid without levels.
+void drawHeat(SDL_Renderer *renderer, const GridSnapshot *snapshot, const Camera *camera, const int* width, const int* height, const int* spacing) {
+    CellWindow view = visibleWindow(camera, *width, *height, snapshot->rows, snapshot->cols);
+    int step = cellStep(camera);
+    int gap = cellGap(camera, spacing);
+    for (int row = view.top; row < view.bottom; row += step) {
+        const uint8_t *heat = &snapshot->heat[(size_t)row * snapshot->cols];
+        for (int col = view.left; col < view.right; col += step) {
+            if (heat[col] != 0) {
+                batchCell(renderer, HEAT_COLORS, heat[col], camera, row, col, step, gap);
             }
         }
     }
+    flushBatches(renderer, HEAT_COLORS);
 }
 
-void drawCursor(SDL_Renderer* renderer, Cursor* cursor, const int* width, const int* height, const int* rows, const int* cols, const int* spacing) {
-    int cursorWidth = *width / *cols;
-    int cursorHeight = *height / *rows;
+// Brighter versions of the open, closed and path colours, in
+// TraceEventType order
+static const Color TRACE_COLORS[BATCH_COLORS] = {
+    {150, 205, 250, 255},
+    {235, 240, 245, 255},
+    {255, 225, 110, 255}
+};
 
+// Flashes the cells search events touched since the last frame over the
+// grid, so the order the search works in shows while it runs
+void drawTrace(SDL_Renderer *renderer, const TraceEvent *events, size_t count, const Camera *camera, int rows, int cols, const int* width, const int* height, const int* spacing) {
+    CellWindow view = visibleWindow(camera, *width, *height, rows, cols);
+    int gap = cellGap(camera, spacing);
+    for (size_t i = 0; i < count; i++) {
+        int row = (int)(events[i].cell / (uint32_t)cols);
+        int col = (int)(events[i].cell % (uint32_t)cols);
+        if (row >= view.top && row < view.bottom && col >= view.left && col < view.right) {
+            batchCell(renderer, TRACE_COLORS, (int)events[i].type, camera, row, col, 1, gap);
+        }
+    }
+    flushBatches(renderer, TRACE_COLORS);
+}
+
+// Maps the mouse through the camera to the cell under it, clamped so the
+// cursor always names a real cell
+void drawCursor(SDL_Renderer* renderer, Cursor* cursor, const Camera *camera, const int* rows, const int* cols, const int* spacing) {
     int mouseX, mouseY;
     SDL_GetMouseState(&mouseX, &mouseY);
 
-    int gridX = mouseX / cursorWidth;
-    int gridY = mouseY / cursorHeight;
-
-    cursor->x = gridX;
-    cursor->y = gridY;
-
-    int screenX = gridX * cursorWidth;
-    int screenY = gridY * cursorHeight;
+    cursor->x = SDL_clamp(screenToCol(camera, mouseX), 0, *cols - 1);
+    cursor->y = SDL_clamp(screenToRow(camera, mouseY), 0, *rows - 1);
 
-    cursor->cell.x = screenX;
-    cursor->cell.y = screenY;
-    cursor->cell.w = cursorWidth - *spacing;
-    cursor->cell.h = cursorHeight - *spacing;
+    int gap = cellGap(camera, spacing);
+    cursor->cell.x = cellScreenX(camera, cursor->x);
+    cursor->cell.y = cellScreenY(camera, cursor->y);
+    cursor->cell.w = SDL_max(cellScreenX(camera, cursor->x + 1) - cursor->cell.x - gap, 1);
+    cursor->cell.h = SDL_max(cellScreenY(camera, cursor->y + 1) - cursor->cell.y - gap, 1);
 
     SDL_SetRenderDrawColor(renderer, cursor->color.r, cursor->color.g, cursor->color.b, cursor->color.a);
     SDL_RenderFillRect(renderer, &cursor->cell);
 }
 
 
-void render(SDL_Renderer *renderer, Cell **grid, Cursor* cursor, const Color* colors, const int* width, const int* height, const int* rows, const int* cols, const int* spacing) {
+void render(SDL_Renderer *renderer, const GridSnapshot *snapshot, LodPyramid *lod, const Camera *camera, GridCanvas *canvas, GridTexture *gridTexture, const TraceEvent *trace, size_t traceCount, Hud *hud, Cursor* cursor, const Color* colors, const int* width, const int* height, const int* spacing) {
     //main rendering logic
+    Uint64 started = SDL_GetPerformanceCounter();
 
     //set background color to white and clear the screen
     SDL_SetRenderDrawColor(renderer, colors[2].r, colors[2].g, colors[2].b, colors[2].a);
     SDL_RenderClear(renderer);
 
     //draw the grid and the cursor
-    drawGrid(renderer, grid, colors, width, height, rows, cols, spacing);
-    drawPath(renderer, grid, colors, width, height, rows, cols, spacing);
-    drawCursor(renderer, cursor, width, height, rows, cols, spacing);
-
-    //present the rendered screen
-    SDL_RenderPresent(renderer);
-}
-
-void randomizeGrid(Cell **grid, const int* rows, const int* cols) {
-    resetGrid(grid, rows, cols);
-    for (int row = 0; row < *rows; row++) {
-        for (int col = 0; col < *cols; col++) {
-            grid[row][col].walkable = rand() % 2;
+    if (gridTexture != NULL) {
+        drawGridTexture(renderer, gridTexture, snapshot, camera, colors, width, height, spacing);
+    } else {
+        if (lod != NULL) {
+            updateLod(lod, snapshot);
+        }
+        if (canvas != NULL) {
+            updateGridCanvas(renderer, canvas, snapshot, lod, camera, colors, width, height, spacing);
+            SDL_RenderCopy(renderer, canvas->target, NULL, NULL);
+        } else {
+            drawGrid(renderer, snapshot, lod, camera, colors, width, height, spacing);
         }
     }
-}
+    if (snapshot->profiling) {
+        drawHeat(renderer, snapshot, camera, width, height, spacing);
+    }
+    if (traceCount > 0) {
+        drawTrace(renderer, trace, traceCount, camera, snapshot->rows, snapshot->cols, width, height, spacing);
+    }
+    drawCursor(renderer, cursor, camera, &snapshot->rows, &snapshot->cols, spacing);
+    if (hud != NULL && hud->visible) {
+        drawHud(renderer, hud, snapshot);
+    }
+    Uint64 drawn = SDL_GetPerformanceCounter();
 
-void resetGrid(Cell **grid, const int* rows, const int* cols) {
-    for (int row = 0; row < *rows; row++) {
-        for (int col = 0; col < *cols; col++) {
-            grid[row][col].walkable = 1;
-            grid[row][col].gCost = 0;
-            grid[row][col].hCost = 0;
-            grid[row][col].fCost = 0;
-            grid[row][col].x = col;
-            grid[row][col].y = row;
-            grid[row][col].isStartCell = 0;
-            grid[row][col].isEndCell = 0;
-            grid[row][col].isPath = 0;
-            grid[row][col].isOpen = 0;
-            grid[row][col].isClosed = 0;
-            grid[row][col].parent = NULL;
-        }
+    //present the rendered screen
+    SDL_RenderPresent(renderer);
+    if (hud != NULL) {
+        noteFrame(hud, started, drawn, SDL_GetPerformanceCounter());
     }
 }
 
-void fillGrid(Cell **grid, const int* rows, const int* cols) {
-    for (int row = 0; row < *rows; row++) {
-        for (int col = 0; col < *cols; col++) {
-            grid[row][col].walkable = 0;
-            grid[row][col].gCost = 0;
-            grid[row][col].hCost = 0;
-            grid[row][col].fCost = 0;
-            grid[row][col].x = col;
-            grid[row][col].y = row;
-            grid[row][col].isStartCell = 0;
-            grid[row][col].isEndCell = 0;
-            grid[row][col].isPath = 0;
-            grid[row][col].isOpen = 0;
-            grid[row][col].isClosed = 0;
-            grid[row][col].parent = NULL;
+void resetGrid(Grid *grid) {
+    setAllWalkable(grid, 1);
+    for (int row = 0; row < grid->rows; row++) {
+        for (int col = 0; col < grid->cols; col++) {
+            Cell *cell = getCell(grid, row, col);
+            cell->gCost = 0;
+            cell->hCost = 0;
+            cell->isStartCell = 0;
+            cell->isEndCell = 0;
+            cell->isPath = 0;
+            cell->isOpen = 0;
+            cell->isClosed = 0;
+            cell->parent = NO_PARENT;
         }
     }
 }
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ring.h"
+
+
+// Rounds the capacity up to a power of two so the free-running counters
+// can wrap without a division
+int initRing(Ring *ring, uint32_t capacity, size_t itemSize) {
+    uint32_t size = 1;
+    while (size < capacity && size < ((uint32_t)1 << 30)) {
+        size <<= 1;
+    }
+    ring->mask = size - 1;
+    ring->itemSize = itemSize;
+    SDL_AtomicSet(&ring->head, 0);
+    SDL_AtomicSet(&ring->tail, 0);
+    ring->items = (unsigned char *)malloc((size_t)size * itemSize);
+    if (ring->items == NULL) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+void freeRing(Ring *ring) {
+    free(ring->items);
+    ring->items = NULL;
+}
+
+// Writer side; returns -1 when the ring is full
+int pushRing(Ring *ring, const void *item) {
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&ring->tail);
+    uint32_t head = (uint32_t)SDL_AtomicGet(&ring->head);
+    if (tail - head > ring->mask) {
+        return -1;
+    }
+    memcpy(ring->items + (size_t)(tail & ring->mask) * ring->itemSize, item, ring->itemSize);
+    SDL_AtomicSet(&ring->tail, (int)(tail + 1));
+    return 0;
+}
+
+// Reader side; returns 0 when the ring is empty
+int popRing(Ring *ring, void *item) {
+    uint32_t head = (uint32_t)SDL_AtomicGet(&ring->head);
+    uint32_t tail = (uint32_t)SDL_AtomicGet(&ring->tail);
+    if (head == tail) {
+        return 0;
+    }
+    memcpy(item, ring->items + (size_t)(head & ring->mask) * ring->itemSize, ring->itemSize);
+    SDL_AtomicSet(&ring->head, (int)(head + 1));
+    return 1;
+}
@@ -0,0 +1,24 @@
+#include "rng.h"
+
+
+static uint64_t splitMix(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Independent generator number `stream` for a seed, so work split into
+// tiles draws the same numbers per tile however the tiles are scheduled
+void seedRngStream(Rng *rng, uint64_t seed, uint64_t stream) {
+    uint64_t state = seed;
+    uint64_t base = splitMix(&state);
+    seedRng(rng, base ^ (stream * 0xD1B54A32D192ED03ull));
+}
+
+// Expands a 64-bit seed into the full state, as the xoshiro authors suggest
+void seedRng(Rng *rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitMix(&seed);
+    }
+}
@@ -0,0 +1,302 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "arena.h"
+#include "generate.h"
+#include "parallel.h"
+#include "render.h"
+#include "simulation.h"
+
+// Longest the thread sleeps when there is no search to run
+#define IDLE_WAIT_MS 250
+
+
+// Moves the start or end flag; only the old and new cells change
+static void moveEndpoint(Simulation *sim, Cell **endpoint, int row, int col, int isStart) {
+    if (*endpoint != NULL) {
+        if (isStart) {
+            (*endpoint)->isStartCell = 0;
+        } else {
+            (*endpoint)->isEndCell = 0;
+        }
+        markCellDirty(sim->grid, *endpoint);
+    }
+    *endpoint = getCell(sim->grid, row, col);
+    if (isStart) {
+        (*endpoint)->isStartCell = 1;
+    } else {
+        (*endpoint)->isEndCell = 1;
+    }
+    markCellDirty(sim->grid, *endpoint);
+}
+
+// Generators rewrite the whole grid; only the flags of the old endpoints
+// need clearing
+static void dropEndpoints(Simulation *sim) {
+    if (sim->startCell != NULL) {
+        sim->startCell->isStartCell = 0;
+    }
+    if (sim->endCell != NULL) {
+        sim->endCell->isEndCell = 0;
+    }
+    sim->startCell = NULL;
+    sim->endCell = NULL;
+}
+
+static inline size_t paintCell(Grid *grid, int row, int col, int walkable) {
+    if (isWalkable(grid, row, col) == walkable) {
+        return 0;
+    }
+    setWalkable(grid, row, col, walkable);
+    markDirty(grid, row, col);
+    return 1;
+}
+
+// Bresenham line from (row, col) to (toRow, toCol). A diagonal step also
+// paints the cell beside it, since the search cuts corners and would slip
+// through a wall drawn one diagonal at a time. Returns the cells changed.
+static size_t paintStroke(Grid *grid, int row, int col, int toRow, int toCol, int walkable) {
+    toRow = SDL_clamp(toRow, 0, grid->rows - 1);
+    toCol = SDL_clamp(toCol, 0, grid->cols - 1);
+    int dCol = abs(toCol - col);
+    int dRow = -abs(toRow - row);
+    int stepCol = col < toCol ? 1 : -1;
+    int stepRow = row < toRow ? 1 : -1;
+    int error = dCol + dRow;
+
+    size_t changed = paintCell(grid, row, col, walkable);
+    while (row != toRow || col != toCol) {
+        int twice = 2 * error;
+        if (twice >= dRow) {
+            error += dRow;
+            col += stepCol;
+            if (twice <= dCol) {
+                changed += paintCell(grid, row, col, walkable);
+            }
+        }
+        if (twice <= dCol) {
+            error += dCol;
+            row += stepRow;
+        }
+        changed += paintCell(grid, row, col, walkable);
+    }
+    return changed;
+}
+
+static void applyCommand(Simulation *sim, const Command *command) {
+    Grid *grid = sim->grid;
+    int row = SDL_clamp(command->row, 0, grid->rows - 1);
+    int col = SDL_clamp(command->col, 0, grid->cols - 1);
+
+    switch (command->type) {
+        case COMMAND_STROKE:
+            // Painting only counts when it changes a cell
+            if (paintStroke(grid, row, col, command->toRow, command->toCol, command->value) == 0) {
+                return;
+            }
+            break;
+        case COMMAND_SET_START:
+            moveEndpoint(sim, &sim->startCell, row, col, 1);
+            break;
+        case COMMAND_SET_END:
+            moveEndpoint(sim, &sim->endCell, row, col, 0);
+            break;
+        case COMMAND_PAUSE:
+            sim->paused = !sim->paused;
+            return;
+        case COMMAND_FINISH:
+            if (sim->search.status != SEARCH_RUNNING && sim->startCell != NULL && sim->endCell != NULL) {
+                startSearch(&sim->search, grid, sim->startCell, sim->endCell);
+                sim->searchStale = 0;
+            }
+            if (sim->search.status == SEARCH_RUNNING) {
+                stepSearch(&sim->search, SIZE_MAX);
+                sim->edited = 1;
+            }
+            return;
+        case COMMAND_TRACE:
+            sim->search.trace = sim->search.trace == NULL ? &sim->trace : NULL;
+            return;
+        case COMMAND_HEAT:
+            if (grid->heat != NULL) {
+                disableHeat(grid);
+            } else {
+                enableHeat(grid);
+            }
+            sim->edited = 1;
+            return;
+        case COMMAND_MAZE:
+            stopSearch(&sim->search);
+            initializeMaze(grid, &sim->rng, sim->threads);
+            break;
+        case COMMAND_ELLER:
+            stopSearch(&sim->search);
+            initializeEllerMaze(grid, &sim->rng);
+            break;
+        case COMMAND_RANDOM:
+        case COMMAND_CAVES:
+        case COMMAND_DUNGEON:
+            stopSearch(&sim->search);
+            if (command->type == COMMAND_RANDOM) {
+                randomizeGrid(grid, &sim->rng, sim->config->density, sim->threads);
+            } else if (command->type == COMMAND_CAVES) {
+                generateCaves(grid, &sim->rng, sim->threads);
+            } else {
+                generateDungeon(grid, &sim->rng);
+            }
+            dropEndpoints(sim);
+            break;
+        case COMMAND_CLEAR:
+            stopSearch(&sim->search);
+            resetGrid(grid);
+            sim->startCell = NULL;
+            sim->endCell = NULL;
+            break;
+    }
+    sim->edited = 1;
+    sim->searchStale = 1;
+}
+
+static void notifyPublished(Simulation *sim) {
+    if (sim->publishedEvent == (Uint32)-1 || SDL_AtomicSet(&sim->notified, 1) != 0) {
+        return;
+    }
+    SDL_Event event;
+    SDL_zero(event);
+    event.type = sim->publishedEvent;
+    SDL_PushEvent(&event);
+}
+
+static int simulate(void *data) {
+    Simulation *sim = (Simulation *)data;
+    reserveSearchArena(sim->config->arenaSize);
+
+    Command command;
+    while (SDL_AtomicGet(&sim->running)) {
+        // Everything queued since the last pass is one batch: a drag's
+        // strokes land in the same dirty set, restart the search once and
+        // go out in a single snapshot
+        while (popRing(&sim->commands, &command)) {
+            applyCommand(sim, &command);
+        }
+
+        // While running, edits restart the search and each publish
+        // advances it by a slice of time
+        if (!sim->paused) {
+            if (sim->searchStale && sim->startCell != NULL && sim->endCell != NULL) {
+                startSearch(&sim->search, sim->grid, sim->startCell, sim->endCell);
+                sim->searchStale = 0;
+            }
+            if (sim->search.status == SEARCH_RUNNING) {
+                runSearch(&sim->search, SDL_GetPerformanceCounter() + sim->searchBudget);
+                sim->edited = 1;
+            }
+        }
+
+        if (sim->edited) {
+            sim->snapshots->stats = sim->search.stats;
+            publishSnapshot(sim->snapshots, sim->grid);
+            sim->edited = 0;
+            notifyPublished(sim);
+        }
+
+        if (sim->paused || sim->search.status != SEARCH_RUNNING) {
+            SDL_SemWaitTimeout(sim->wake, IDLE_WAIT_MS);
+        }
+    }
+
+    stopSearch(&sim->search);
+    Arena *arena = searchArena();
+    printf("Search arena: %zu bytes peak, %zu bytes reserved, %zu mid-query mallocs\n", arena->highWater, arenaCapacity(arena), arena->blockMallocs);
+    freeArena(arena);
+    return 0;
+}
+
+// From here on the grid belongs to the simulation thread until
+// stopSimulation() returns. publishedEvent is an SDL user event type, or
+// (Uint32)-1 for none.
+int startSimulation(Simulation *sim, Grid *grid, SnapshotBuffer *snapshots, const Config *config, Uint32 publishedEvent) {
+    sim->grid = grid;
+    sim->snapshots = snapshots;
+    sim->config = config;
+    sim->threads = config->threads > 0 ? config->threads : defaultThreadCount();
+    seedRng(&sim->rng, config->seed);
+    initSearch(&sim->search);
+    sim->startCell = NULL;
+    sim->endCell = NULL;
+    sim->paused = 1;
+    sim->edited = 1;
+    sim->searchStale = 1;
+    sim->searchBudget = SDL_GetPerformanceFrequency() * (Uint64)config->searchBudget / 1000;
+    sim->publishedEvent = publishedEvent;
+    SDL_AtomicSet(&sim->notified, 0);
+    SDL_AtomicSet(&sim->running, 1);
+
+    if (initRing(&sim->commands, COMMAND_CAPACITY, sizeof(Command)) != 0) {
+        return -1;
+    }
+    if (initRing(&sim->trace, TRACE_CAPACITY, sizeof(TraceEvent)) != 0) {
+        freeRing(&sim->commands);
+        return -1;
+    }
+    sim->search.trace = config->trace ? &sim->trace : NULL;
+    if (config->heat) {
+        enableHeat(grid);
+    }
+    sim->wake = SDL_CreateSemaphore(0);
+    if (sim->wake == NULL) {
+        fprintf(stderr, "Could not create semaphore: %s\n", SDL_GetError());
+        freeRing(&sim->trace);
+        freeRing(&sim->commands);
+        return -1;
+    }
+    sim->thread = SDL_CreateThread(simulate, "simulation", sim);
+    if (sim->thread == NULL) {
+        fprintf(stderr, "Could not create thread: %s\n", SDL_GetError());
+        SDL_DestroySemaphore(sim->wake);
+        freeRing(&sim->trace);
+        freeRing(&sim->commands);
+        return -1;
+    }
+    return 0;
+}
+
+void stopSimulation(Simulation *sim) {
+    SDL_AtomicSet(&sim->running, 0);
+    SDL_SemPost(sim->wake);
+    SDL_WaitThread(sim->thread, NULL);
+    SDL_DestroySemaphore(sim->wake);
+    if (sim->search.traceDropped > 0) {
+        printf("Search trace: %zu events dropped\n", sim->search.traceDropped);
+    }
+    freeRing(&sim->trace);
+    freeRing(&sim->commands);
+}
+
+// Never waits; returns -1 if the simulation is too far behind to take it
+static int pushCommand(Simulation *sim, const Command *command) {
+    if (pushRing(&sim->commands, command) != 0) {
+        return -1;
+    }
+    SDL_SemPost(sim->wake);
+    return 0;
+}
+
+int sendCommand(Simulation *sim, CommandType type, int row, int col, int value) {
+    Command command = {type, row, col, value, row, col};
+    return pushCommand(sim, &command);
+}
+
+// Paints every cell on the line between two cells, walls unless walkable
+int sendStroke(Simulation *sim, int row, int col, int toRow, int toCol, int walkable) {
+    Command command = {COMMAND_STROKE, row, col, walkable, toRow, toCol};
+    return pushCommand(sim, &command);
+}
+
+// Render side; appends the search events that arrived since the last call
+size_t drainTrace(Simulation *sim, TraceEvent *events, size_t capacity) {
+    size_t count = 0;
+    while (count < capacity && popRing(&sim->trace, &events[count])) {
+        count++;
+    }
+    return count;
+}
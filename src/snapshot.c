@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+
+
+// Display state for every combination of the STATE_ flags, filled once by
+// initSnapshots(); the highest state present wins
+static uint8_t STATE_TABLE[STATE_FLAG_COMBINATIONS];
+
+static void buildStateTable(void) {
+    for (int flags = 0; flags < STATE_FLAG_COMBINATIONS; flags++) {
+        CellState state = CELL_FLOOR;
+        if (flags & STATE_CLOSED) {
+            state = CELL_CLOSED;
+        }
+        if (flags & STATE_OPEN) {
+            state = CELL_OPEN;
+        }
+        if (!(flags & STATE_WALKABLE)) {
+            state = CELL_WALL;
+        }
+        if (flags & STATE_PATH) {
+            state = CELL_PATH;
+        }
+        if (flags & STATE_START) {
+            state = CELL_START;
+        }
+        if (flags & STATE_END) {
+            state = CELL_END;
+        }
+        STATE_TABLE[flags] = (uint8_t)state;
+    }
+}
+
+static int initChangeSet(ChangeSet *set, size_t capacity) {
+    set->capacity = capacity;
+    set->count = 0;
+    set->overflow = 1;
+    set->epoch = 0;
+    set->cells = (uint32_t *)malloc((capacity + 1) * sizeof(uint32_t));
+    return set->cells == NULL ? -1 : 0;
+}
+
+static void addChange(ChangeSet *set, uint32_t index) {
+    if (set->count < set->capacity) {
+        set->cells[set->count++] = index;
+    } else {
+        set->overflow = 1;
+    }
+}
+
+int initSnapshots(SnapshotBuffer *snapshots, int rows, int cols) {
+    buildStateTable();
+    size_t limit = dirtyLimit(rows, cols);
+    int failed = 0;
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        GridSnapshot *snapshot = &snapshots->buffers[i];
+        snapshot->rows = rows;
+        snapshot->cols = cols;
+        snapshot->epoch = 0;
+        snapshot->baseEpoch = 0;
+        snapshot->states = (uint8_t *)calloc((size_t)rows * cols, sizeof(uint8_t));
+        // Usually a publish or two of dirty cells, past that it is cheaper
+        // to redraw everything anyway
+        snapshot->changeCapacity = 2 * limit;
+        snapshot->changeCount = 0;
+        snapshot->allChanged = 1;
+        snapshot->changes = (uint32_t *)malloc((snapshot->changeCapacity + 1) * sizeof(uint32_t));
+        snapshot->heat = NULL;
+        snapshot->profiling = 0;
+        memset(&snapshot->stats, 0, sizeof(snapshot->stats));
+        failed |= snapshot->states == NULL || snapshot->changes == NULL;
+        failed |= initChangeSet(&snapshots->missed[i], 2 * limit);
+    }
+    for (int i = 0; i < SNAPSHOT_HISTORY; i++) {
+        failed |= initChangeSet(&snapshots->history[i], 2 * limit);
+    }
+    if (failed) {
+        fprintf(stderr, "Memory allocation failed\n");
+        freeSnapshots(snapshots);
+        return -1;
+    }
+
+    snapshots->front = 0;
+    SDL_AtomicSet(&snapshots->middle, 1);
+    snapshots->back = 2;
+    snapshots->latest = -1;
+    snapshots->epoch = 0;
+    memset(&snapshots->stats, 0, sizeof(snapshots->stats));
+    SDL_AtomicSet(&snapshots->taken, 0);
+    return 0;
+}
+
+void freeSnapshots(SnapshotBuffer *snapshots) {
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        free(snapshots->buffers[i].states);
+        free(snapshots->buffers[i].changes);
+        free(snapshots->buffers[i].heat);
+        free(snapshots->missed[i].cells);
+        snapshots->buffers[i].states = NULL;
+        snapshots->buffers[i].changes = NULL;
+        snapshots->buffers[i].heat = NULL;
+        snapshots->missed[i].cells = NULL;
+    }
+    for (int i = 0; i < SNAPSHOT_HISTORY; i++) {
+        free(snapshots->history[i].cells);
+        snapshots->history[i].cells = NULL;
+    }
+}
+
+// Packs the cell's flags and looks the state up, without branching on them.
+// Search flags only count for cells in the current search.
+CellState cellState(const Grid *grid, int row, int col) {
+    const Cell *cell = getCell(grid, row, col);
+    unsigned int search = (unsigned int)inSearch(grid, cell);
+    unsigned int flags = (unsigned int)isWalkable(grid, row, col)
+                       | (search & cell->isClosed) << 1
+                       | (search & cell->isOpen) << 2
+                       | (search & cell->isPath) << 3
+                       | (unsigned int)cell->isStartCell << 4
+                       | (unsigned int)cell->isEndCell << 5;
+    return (CellState)STATE_TABLE[flags];
+}
+
+// Writes one cell of the back buffer and lists it if it changed. Heat
+// only changes on dirty cells, so while profiling every composed cell is
+// listed rather than comparing heat too.
+static inline void composeCell(GridSnapshot *back, const GridSnapshot *latest, const Grid *grid, int row, int col, size_t index, ChangeSet *delta) {
+    uint8_t state = (uint8_t)cellState(grid, row, col);
+    back->states[index] = state;
+    if (back->profiling) {
+        back->heat[index] = heatLevel(grid->heat[index]);
+    }
+    if (latest == NULL || back->profiling || state != latest->states[index]) {
+        addChange(delta, (uint32_t)index);
+    }
+}
+
+static void composeCells(GridSnapshot *back, const GridSnapshot *latest, const Grid *grid, const uint32_t *cells, size_t count, ChangeSet *delta) {
+    for (size_t i = 0; i < count; i++) {
+        composeCell(back, latest, grid, (int)(cells[i] / grid->cols), (int)(cells[i] % grid->cols), cells[i], delta);
+    }
+}
+
+// Heat arrays are only allocated once a grid starts profiling. Turning
+// profiling on or off dirties every cell, so the buffer is fully composed.
+static void prepareHeat(GridSnapshot *back, const Grid *grid) {
+    back->profiling = grid->heat != NULL;
+    if (back->profiling && back->heat == NULL) {
+        back->heat = (uint8_t *)malloc((size_t)back->rows * back->cols);
+        if (back->heat == NULL) {
+            fprintf(stderr, "Memory allocation failed\n");
+            back->profiling = 0;
+        }
+    }
+}
+
+// Lists every cell changed by the publishes after `since`, so a reader
+// still showing that epoch (or any later one) can catch up
+static void listChanges(SnapshotBuffer *snapshots, GridSnapshot *back, unsigned int since) {
+    back->baseEpoch = since;
+    back->changeCount = 0;
+    back->allChanged = since == 0 || back->epoch - since > SNAPSHOT_HISTORY;
+    for (unsigned int epoch = since + 1; epoch <= back->epoch && !back->allChanged; epoch++) {
+        const ChangeSet *delta = &snapshots->history[epoch % SNAPSHOT_HISTORY];
+        if (delta->epoch != epoch || delta->overflow || back->changeCount + delta->count > back->changeCapacity) {
+            back->allChanged = 1;
+            break;
+        }
+        memcpy(back->changes + back->changeCount, delta->cells, delta->count * sizeof(uint32_t));
+        back->changeCount += delta->count;
+    }
+}
+
+// Writer side. Composes the grid into the back buffer and makes it the
+// newest snapshot; the buffer that comes back from the middle slot is the
+// next back buffer.
+void publishSnapshot(SnapshotBuffer *snapshots, Grid *grid) {
+    GridSnapshot *back = &snapshots->buffers[snapshots->back];
+    ChangeSet *missed = &snapshots->missed[snapshots->back];
+    unsigned int epoch = snapshots->epoch + 1;
+    ChangeSet *delta = &snapshots->history[epoch % SNAPSHOT_HISTORY];
+    delta->count = 0;
+    delta->overflow = 0;
+    delta->epoch = epoch;
+
+    prepareHeat(back, grid);
+    const GridSnapshot *latest = snapshots->latest >= 0 ? &snapshots->buffers[snapshots->latest] : NULL;
+    if (latest == NULL || grid->dirty.all || missed->overflow) {
+        // The back buffer may be behind anywhere; compose it all, still
+        // listing what differs so readers can redraw just that
+        for (int row = 0; row < grid->rows; row++) {
+            size_t offset = (size_t)row * grid->cols;
+            for (int col = 0; col < grid->cols; col++) {
+                composeCell(back, latest, grid, row, col, offset + col, delta);
+            }
+        }
+    } else {
+        composeCells(back, latest, grid, missed->cells, missed->count, delta);
+        composeCells(back, latest, grid, grid->dirty.cells, grid->dirty.count, delta);
+    }
+    missed->count = 0;
+    missed->overflow = 0;
+
+    // The other two buffers are now behind on whatever was dirty
+    for (int i = 0; i < SNAPSHOT_BUFFERS; i++) {
+        if (i == snapshots->back) {
+            continue;
+        }
+        if (grid->dirty.all) {
+            snapshots->missed[i].overflow = 1;
+        } else {
+            for (size_t j = 0; j < grid->dirty.count; j++) {
+                addChange(&snapshots->missed[i], grid->dirty.cells[j]);
+            }
+        }
+    }
+    clearDirty(grid);
+
+    // The reader may skip snapshots, so list changes from the last one it
+    // took rather than the last one published. Reading `taken` a little
+    // late only makes the list longer than needed.
+    back->epoch = epoch;
+    back->stats = snapshots->stats;
+    listChanges(snapshots, back, (unsigned int)SDL_AtomicGet(&snapshots->taken));
+
+    snapshots->epoch = epoch;
+    snapshots->latest = snapshots->back;
+    snapshots->back = SDL_AtomicSet(&snapshots->middle, snapshots->back | SNAPSHOT_FRESH) & SNAPSHOT_INDEX;
+}
+
+// Reader side. Returns the newest published snapshot, which stays valid
+// and unchanged until the next call.
+const GridSnapshot* acquireSnapshot(SnapshotBuffer *snapshots) {
+    if (SDL_AtomicGet(&snapshots->middle) & SNAPSHOT_FRESH) {
+        snapshots->front = SDL_AtomicSet(&snapshots->middle, snapshots->front) & SNAPSHOT_INDEX;
+        SDL_AtomicSet(&snapshots->taken, (int)snapshots->buffers[snapshots->front].epoch);
+    }
+    return &snapshots->buffers[snapshots->front];
+}